@@ -11,13 +11,31 @@ using namespace Loop;
 constexpr CCTK_REAL onepi = M_PI;
 constexpr CCTK_REAL twopi = 2.0 * M_PI;
 
+/// Bit masks of the Cartesian coordinate planes x = 0, y = 0 and z = 0
+enum SymmetryPlane : int { sym_x = 1, sym_y = 2, sym_z = 4 };
+
+/// Reflection symmetries; the domain is restricted to the positive side of
+/// each symmetry plane
+enum class Symmetry : int {
+  none = 0,
+  bitant = sym_z,
+  quadrant = sym_x | sym_y,
+  octant = sym_x | sym_y | sym_z
+};
+
 struct FaceInfo {
   bool is_outer_boundary{true};
+  /// Planes reflected across when mirroring through this face. A face with a
+  /// nonzero mask is a symmetry boundary; its ghost zones are filled by
+  /// `apply_symmetries`.
+  int symmetry{0};
 };
 
 constexpr FaceInfo outer_face{true};
 constexpr FaceInfo inner_face{false};
 
+constexpr FaceInfo symmetry_face(int planes) { return FaceInfo{true, planes}; }
+
 using Index = std::array<CCTK_INT, dim>;
 using Coord = std::array<CCTK_REAL, dim>;
 using Jac_t = std::array<std::array<CCTK_REAL, 3>, 3>;
@@ -0,0 +1,313 @@
+#include <cctk.h>
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include "CurvBase_Extraction.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+namespace CurvBase {
+using namespace Loop;
+
+namespace {
+
+// Find the patch whose domain contains the global point `g`. As in
+// MultiPatchView::owner, the local coordinates have to map back onto the
+// point: some coordinate maps are also defined outside their domain, e.g. a
+// cubed-sphere wedge accepts points on the opposite side of the origin.
+std::pair<std::size_t, Coord> locate(const MultiPatch &mp, const Coord &g) {
+  constexpr CCTK_REAL tol = 1.0e-12;
+  const CCTK_REAL scale =
+      CCTK_REAL{1} + std::fabs(g[0]) + std::fabs(g[1]) + std::fabs(g[2]);
+  for (std::size_t id = 0; id < mp.size(); ++id) {
+    const Patch &patch = *mp.get_patch(id);
+    const Coord l = patch.g2l(g);
+    if (!patch.is_valid(l))
+      continue;
+    bool inside = true;
+    for (int d = 0; d < dim; ++d) {
+      const CCTK_REAL eps = tol * (patch.xmax[d] - patch.xmin[d]);
+      inside &= l[d] >= patch.xmin[d] - eps && l[d] <= patch.xmax[d] + eps;
+    }
+    if (!inside)
+      continue;
+    const Coord back = patch.l2g(l);
+    if (std::fabs(back[0] - g[0]) + std::fabs(back[1] - g[1]) +
+            std::fabs(back[2] - g[2]) <=
+        1.0e-10 * scale)
+      return {id, l};
+  }
+  CCTK_VERROR("Extraction point (%g, %g, %g) lies outside all patches", g[0],
+              g[1], g[2]);
+}
+
+// Lagrange stencil of the given order around the continuous cell index `s`
+void make_stencil(const CCTK_REAL s, const int order, int &cell, int &base,
+                  std::array<CCTK_REAL, max_extraction_order + 1> &weights) {
+  cell = static_cast<int>(std::floor(s + CCTK_REAL{0.5}));
+  base = (order % 2 != 0)
+             ? static_cast<int>(std::floor(s)) - (order - 1) / 2
+             : cell - order / 2;
+  weights.fill(0);
+  for (int a = 0; a <= order; ++a) {
+    CCTK_REAL w = 1;
+    for (int b = 0; b <= order; ++b)
+      if (b != a)
+        w *= (s - (base + b)) / CCTK_REAL(a - b);
+    weights[a] = w;
+  }
+}
+
+} // namespace
+
+SphereExtraction::SphereExtraction(std::vector<ExtractionSphere> spheres,
+                                   const int order, const int level)
+    : spheres_(std::move(spheres)), order_(order), level_(level) {
+  if (order_ < 1 || order_ > max_extraction_order)
+    CCTK_VERROR("Extraction order %d is not in [1, %d]", order_,
+                max_extraction_order);
+
+  offsets_.resize(spheres_.size());
+  for (std::size_t s = 0; s < spheres_.size(); ++s) {
+    const ExtractionSphere &sph = spheres_[s];
+    if (sph.radius <= 0 || sph.ntheta <= 0 || sph.nphi <= 0)
+      CCTK_VERROR("Extraction sphere %zu needs a positive radius and size", s);
+    offsets_[s] = npoints_;
+    npoints_ += static_cast<std::size_t>(sph.ntheta) * sph.nphi;
+  }
+
+  const MultiPatch &mp = multipatch();
+  const CCTK_REAL levfac = std::ldexp(CCTK_REAL{1}, level_);
+
+  std::vector<ExtractionStencil> stencils(npoints_);
+  jac_.resize(npoints_);
+  inv_jac_.resize(npoints_);
+
+  for (std::size_t s = 0; s < spheres_.size(); ++s) {
+    const ExtractionSphere &sph = spheres_[s];
+    for (int i = 0; i < sph.ntheta; ++i) {
+      for (int j = 0; j < sph.nphi; ++j) {
+        const std::size_t n = offsets_[s] + i * sph.nphi + j;
+
+        const CCTK_REAL th = theta(s, i), ph = phi(s, j);
+        const CCTK_REAL st = std::sin(th), ct = std::cos(th);
+        const CCTK_REAL sp = std::sin(ph), cp = std::cos(ph);
+        const CCTK_REAL r = sph.radius;
+        const Coord x = {r * st * cp, r * st * sp, r * ct};
+        const Coord g = {sph.center[0] + x[0], sph.center[1] + x[1],
+                         sph.center[2] + x[2]};
+
+        const auto [id, l] = locate(mp, g);
+        const Patch &patch = *mp.get_patch(id);
+
+        ExtractionStencil &stencil = stencils[n];
+        stencil.patch = static_cast<int>(id);
+        stencil.target = static_cast<int>(n);
+        for (int d = 0; d < dim; ++d) {
+          const CCTK_REAL dx = patch.dx[d] / levfac;
+          const CCTK_REAL sd = (l[d] - patch.xmin[d]) / dx - CCTK_REAL{0.5};
+          make_stencil(sd, order_, stencil.cell[d], stencil.base[d],
+                       stencil.weights[d]);
+          // A point on the upper patch face would otherwise be assigned to
+          // a cell outside the patch, which no box owns
+          const int ncells = static_cast<int>(patch.ncells[d] * levfac);
+          stencil.cell[d] = std::clamp(stencil.cell[d], 0, ncells - 1);
+        }
+
+        // dr^a/dx^i, and dx^i/dr^a stored as inv_jac_[n][i][a]
+        jac_[n] = jac_cart2sph_cart(x);
+        inv_jac_[n] = {{{st * cp, r * ct * cp, -r * st * sp},
+                        {st * sp, r * ct * sp, r * st * cp},
+                        {ct, -r * st, 0}}};
+      }
+    }
+  }
+
+  // Sort by patch, then by cell with the slowest index first
+  std::sort(stencils.begin(), stencils.end(),
+            [](const ExtractionStencil &a, const ExtractionStencil &b) {
+              return std::tie(a.patch, a.cell[2], a.cell[1], a.cell[0]) <
+                     std::tie(b.patch, b.cell[2], b.cell[1], b.cell[0]);
+            });
+
+  patch_offsets_.assign(mp.size() + 1, 0);
+  for (const ExtractionStencil &stencil : stencils)
+    ++patch_offsets_[stencil.patch + 1];
+  for (std::size_t id = 0; id < mp.size(); ++id)
+    patch_offsets_[id + 1] += patch_offsets_[id];
+
+  stencil_cellz_.resize(npoints_);
+  for (std::size_t n = 0; n < npoints_; ++n)
+    stencil_cellz_[n] = stencils[n].cell[2];
+
+  stencils_.resize(npoints_);
+  amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, stencils.begin(),
+                        stencils.end(), stencils_.begin());
+  amrex::Gpu::streamSynchronize();
+}
+
+void SphereExtraction::begin(const std::size_t nvars) {
+  nvars_ = nvars;
+  device_results_.resize(nvars_ * npoints_);
+  CCTK_REAL *const results = device_results_.data();
+  amrex::ParallelFor(device_results_.size(),
+                     [=] AMREX_GPU_DEVICE(std::size_t n) { results[n] = 0; });
+  // The boxes may be gathered on other streams
+  amrex::Gpu::streamSynchronize();
+  results_.clear();
+}
+
+void SphereExtraction::gather(const cGH *const cctkGH,
+                              const GridDescBaseDevice &grid,
+                              const std::vector<int> &varindices) {
+  if (varindices.size() != nvars_)
+    CCTK_VERROR("Extraction was begun for %zu variables, but %zu were given",
+                nvars_, varindices.size());
+  if (ilogb(cctkGH->cctk_levfac[0]) != level_)
+    return;
+  const int patch = grid.patch;
+  if (patch + 1 >= static_cast<int>(patch_offsets_.size()))
+    return;
+
+  for (int d = 0; d < dim; ++d)
+    if (grid.nghostzones[d] < (order_ + 1) / 2)
+      CCTK_VERROR("Extraction of order %d needs at least %d ghost zones",
+                  order_, (order_ + 1) / 2);
+
+  // Interior cells of this box in the index space of the patch; every point
+  // is owned by the one box whose interior holds its nearest cell
+  vect<int, dim> imin, imax;
+  grid.box_int<1, 1, 1>(grid.nghostzones, imin, imax);
+  std::array<int, dim> lbnd, lo, hi;
+  for (int d = 0; d < dim; ++d) {
+    lbnd[d] = grid.lbnd[d];
+    lo[d] = lbnd[d] + imin[d];
+    hi[d] = lbnd[d] + imax[d];
+  }
+
+  // The stencils are sorted by cell, so the candidates are contiguous
+  const auto cellz_begin = stencil_cellz_.begin() + patch_offsets_[patch];
+  const auto cellz_end = stencil_cellz_.begin() + patch_offsets_[patch + 1];
+  const std::size_t first =
+      std::lower_bound(cellz_begin, cellz_end, lo[2]) - stencil_cellz_.begin();
+  const std::size_t last =
+      std::lower_bound(cellz_begin, cellz_end, hi[2]) - stencil_cellz_.begin();
+  if (first == last)
+    return;
+
+  std::vector<const CCTK_REAL *> ptrs(nvars_);
+  for (std::size_t v = 0; v < nvars_; ++v) {
+    if (CCTK_GroupTypeFromVarI(varindices[v]) != CCTK_GF)
+      CCTK_VERROR("Variable %d is not a grid function", varindices[v]);
+    ptrs[v] = static_cast<const CCTK_REAL *>(
+        CCTK_VarDataPtrI(cctkGH, 0, varindices[v]));
+    if (ptrs[v] == nullptr)
+      CCTK_VERROR("Variable %d has no storage", varindices[v]);
+  }
+
+  const GF3D2layout layout(cctkGH, {1, 1, 1});
+  const ExtractionStencil *const stencils = stencils_.data() + first;
+  CCTK_REAL *const results = device_results_.data();
+  const std::size_t npoints = npoints_;
+  const int npts = order_ + 1;
+
+  // The grid function pointers are passed by value, a batch at a time, so
+  // that no device memory is allocated and the kernels need not be waited
+  // for
+  for (std::size_t v0 = 0; v0 < nvars_; v0 += max_gather_vars) {
+    const std::size_t nv = std::min(nvars_ - v0, max_gather_vars);
+    std::array<const CCTK_REAL *, max_gather_vars> gfs{};
+    std::copy_n(ptrs.begin() + v0, nv, gfs.begin());
+
+    amrex::ParallelFor(last - first, [=] AMREX_GPU_DEVICE(std::size_t n) {
+      const ExtractionStencil &st = stencils[n];
+      for (int d = 0; d < dim; ++d)
+        if (st.cell[d] < lo[d] || st.cell[d] >= hi[d])
+          return;
+
+      const int i0 = st.base[0] - lbnd[0];
+      const int j0 = st.base[1] - lbnd[1];
+      const int k0 = st.base[2] - lbnd[2];
+      for (std::size_t v = 0; v < nv; ++v) {
+        const CCTK_REAL *const gf = gfs[v];
+        CCTK_REAL sum = 0;
+        for (int c = 0; c < npts; ++c) {
+          for (int b = 0; b < npts; ++b) {
+            const CCTK_REAL wbc = st.weights[1][b] * st.weights[2][c];
+            for (int a = 0; a < npts; ++a)
+              sum += st.weights[0][a] * wbc *
+                     gf[layout.linear(i0 + a, j0 + b, k0 + c)];
+          }
+        }
+        results[(v0 + v) * npoints + st.target] = sum;
+      }
+    });
+  }
+}
+
+void SphereExtraction::finish() {
+  // Wait for the gather kernels of all boxes, whichever stream they ran on
+  amrex::Gpu::synchronize();
+  results_.resize(device_results_.size());
+  amrex::Gpu::copyAsync(amrex::Gpu::deviceToHost, device_results_.begin(),
+                        device_results_.end(), results_.begin());
+  amrex::Gpu::streamSynchronize();
+  amrex::ParallelDescriptor::ReduceRealSum(results_.data(),
+                                           static_cast<int>(results_.size()));
+}
+
+void SphereExtraction::to_spherical_vector(
+    const std::array<std::size_t, 3> &vars) {
+  for (std::size_t n = 0; n < npoints_; ++n) {
+    std::array<CCTK_REAL, 3> v;
+    for (int i = 0; i < 3; ++i)
+      v[i] = results_[vars[i] * npoints_ + n];
+    for (int a = 0; a < 3; ++a) {
+      CCTK_REAL sum = 0;
+      for (int i = 0; i < 3; ++i)
+        sum += jac_[n][a][i] * v[i];
+      results_[vars[a] * npoints_ + n] = sum;
+    }
+  }
+}
+
+void SphereExtraction::to_spherical_covector(
+    const std::array<std::size_t, 3> &vars) {
+  for (std::size_t n = 0; n < npoints_; ++n) {
+    std::array<CCTK_REAL, 3> v;
+    for (int i = 0; i < 3; ++i)
+      v[i] = results_[vars[i] * npoints_ + n];
+    for (int a = 0; a < 3; ++a) {
+      CCTK_REAL sum = 0;
+      for (int i = 0; i < 3; ++i)
+        sum += inv_jac_[n][i][a] * v[i];
+      results_[vars[a] * npoints_ + n] = sum;
+    }
+  }
+}
+
+void SphereExtraction::to_spherical_tensor(
+    const std::array<std::size_t, 6> &vars) {
+  // Position of the (i, j) component in the list of symmetric components
+  constexpr int sym[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+  for (std::size_t n = 0; n < npoints_; ++n) {
+    std::array<CCTK_REAL, 6> t;
+    for (int c = 0; c < 6; ++c)
+      t[c] = results_[vars[c] * npoints_ + n];
+    for (int a = 0; a < 3; ++a) {
+      for (int b = a; b < 3; ++b) {
+        CCTK_REAL sum = 0;
+        for (int i = 0; i < 3; ++i)
+          for (int j = 0; j < 3; ++j)
+            sum += inv_jac_[n][i][a] * inv_jac_[n][j][b] * t[sym[i][j]];
+        results_[vars[sym[a][b]] * npoints_ + n] = sum;
+      }
+    }
+  }
+}
+
+} // namespace CurvBase
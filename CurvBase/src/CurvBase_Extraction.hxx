@@ -0,0 +1,146 @@
+#ifndef CURVBASE_EXTRACTION_HXX
+#define CURVBASE_EXTRACTION_HXX
+
+/**
+ * @file
+ * @brief Interpolation of cell-centered grid functions onto coordinate
+ * spheres, for wave extraction on multipatch grids.
+ */
+
+#include <AMReX_Gpu.H>
+#include <AMReX_GpuContainers.H>
+
+#include <cctk.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "CurvBase_MultiPatch.hxx"
+
+namespace CurvBase {
+
+/// A coordinate sphere sampled at the midpoints of an (ntheta x nphi) grid
+struct ExtractionSphere {
+  CCTK_REAL radius;
+  Coord center{0, 0, 0};
+  int ntheta, nphi;
+};
+
+/// Highest supported Lagrange interpolation order
+constexpr int max_extraction_order = 7;
+
+/// Grid functions interpolated by one kernel launch
+constexpr std::size_t max_gather_vars = 8;
+
+/**
+ * @brief Interpolation stencil of one extraction point, in the index space of
+ * its patch on the extraction level.
+ */
+struct ExtractionStencil {
+  int patch;
+  std::array<int, dim> cell; ///< nearest cell; its owner box interpolates
+  std::array<int, dim> base; ///< first cell of the stencil
+  std::array<std::array<CCTK_REAL, max_extraction_order + 1>, dim> weights;
+  int target; ///< index of the point in the result arrays
+};
+
+/**
+ * @brief Batched Lagrange interpolation onto a set of spheres.
+ *
+ * Everything that depends only on the point positions is computed once, at
+ * construction: the owning patch, the stencil and its weights, and the
+ * Jacobian to the spherical basis. The stencils are sorted by patch and by
+ * cell, so that each box only visits the points it owns.
+ *
+ * An extraction is done in three steps:
+ * 1. `begin` (global mode) clears the results for `nvars` grid functions,
+ * 2. `gather` (local mode) interpolates all of them at the points owned by
+ *    the current box,
+ * 3. `finish` (global mode) combines the results of all processes.
+ *
+ * The results of each sphere and variable are then contiguous arrays with
+ * `phi` running fastest, ready for a spherical-harmonic projection.
+ */
+class SphereExtraction {
+  std::vector<ExtractionSphere> spheres_;
+  std::vector<std::size_t> offsets_; // first point of each sphere
+  std::size_t npoints_{0};
+  int order_, level_;
+
+  // Stencils sorted by patch and cell, and where each patch starts
+  amrex::Gpu::DeviceVector<ExtractionStencil> stencils_;
+  std::vector<std::size_t> patch_offsets_;
+  std::vector<int> stencil_cellz_; // host copy of stencils_[n].cell[2]
+
+  // Jacobian d(r,theta,phi)/d(x,y,z) and its inverse at each point
+  std::vector<Jac_t> jac_, inv_jac_;
+
+  std::size_t nvars_{0};
+  amrex::Gpu::DeviceVector<CCTK_REAL> device_results_;
+  std::vector<CCTK_REAL> results_;
+
+public:
+  /**
+   * @param spheres The spheres to sample
+   * @param order Lagrange interpolation order; the grid functions need at
+   * least (order + 1) / 2 ghost zones
+   * @param level Refinement level to interpolate from
+   */
+  CCTK_HOST SphereExtraction(std::vector<ExtractionSphere> spheres, int order,
+                             int level = 0);
+
+  [[nodiscard]] CCTK_HOST std::size_t num_spheres() const noexcept {
+    return spheres_.size();
+  }
+
+  [[nodiscard]] CCTK_HOST std::size_t num_points() const noexcept {
+    return npoints_;
+  }
+
+  [[nodiscard]] CCTK_HOST const ExtractionSphere &
+  sphere(std::size_t s) const noexcept {
+    return spheres_[s];
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_REAL theta(std::size_t s, int i) const noexcept {
+    return (i + CCTK_REAL{0.5}) * onepi / spheres_[s].ntheta;
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_REAL phi(std::size_t s, int j) const noexcept {
+    return j * twopi / spheres_[s].nphi;
+  }
+
+  /// Clear the results for `nvars` grid functions
+  CCTK_HOST void begin(std::size_t nvars);
+
+  /// Interpolate the given cell-centered grid functions at the points owned
+  /// by the current box. Call in local mode, once per box. The kernels run
+  /// asynchronously; `finish` waits for them.
+  CCTK_HOST void gather(const cGH *cctkGH, const Loop::GridDescBaseDevice &grid,
+                        const std::vector<int> &varindices);
+
+  /// Wait for all boxes and sum the contributions of all processes
+  CCTK_HOST void finish();
+
+  /// Values of variable `var` on sphere `s`, indexed by `i * nphi + j`
+  [[nodiscard]] CCTK_HOST const CCTK_REAL *values(std::size_t s,
+                                                  std::size_t var) const {
+    return &results_[var * npoints_ + offsets_[s]];
+  }
+
+  // --- Change of basis from Cartesian to (r, theta, phi) components ---
+
+  /// Contravariant vector, e.g. the shift
+  CCTK_HOST void to_spherical_vector(const std::array<std::size_t, 3> &vars);
+
+  /// Covariant vector
+  CCTK_HOST void to_spherical_covector(const std::array<std::size_t, 3> &vars);
+
+  /// Symmetric covariant tensor (xx, xy, xz, yy, yz, zz), e.g. the 3-metric
+  CCTK_HOST void to_spherical_tensor(const std::array<std::size_t, 6> &vars);
+};
+
+} // namespace CurvBase
+
+#endif // #ifndef CURVBASE_EXTRACTION_HXX
@@ -4,28 +4,89 @@
 
 #include "CurvBase_MultiPatch.hxx"
 
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+
 namespace CurvBase {
 using namespace Loop;
 
-AMREX_GPU_MANAGED AMP *g_active_mp = nullptr;
+namespace {
+std::unique_ptr<MultiPatch> g_multipatch;
+} // namespace
+
+CCTK_HOST MultiPatch &multipatch() {
+  assert(g_multipatch != nullptr);
+  return *g_multipatch;
+}
+
+CCTK_HOST MultiPatchView active_mp() { return multipatch().device_view(); }
+
+//==============================================================================
+// Geometry Cache
+//==============================================================================
+
+namespace {
 
-CCTK_HOST CCTK_DEVICE AMP *active_mp() { return g_active_mp; }
+constexpr int nvgeom = 3;          // vertex coordinates
+// cell coordinates, volume, overlap mask, Jacobians, dJacobians
+constexpr int ncgeom = 3 + 1 + 1 + 9 + 18;
+
+// A box is identified by its patch, refinement level and index extent; its
+// geometry depends on nothing else
+struct GeometryKey {
+  int patch, level;
+  std::array<int, dim> lbnd, lsh;
+
+  bool operator<(const GeometryKey &other) const {
+    return std::tie(patch, level, lbnd, lsh) <
+           std::tie(other.patch, other.level, other.lbnd, other.lsh);
+  }
+};
+
+// Geometry of one box, stored component by component in the layout of the
+// grid functions, ghost zones included. The setup routine runs once per tile,
+// so the storage is allocated by the first tile of the box, and each tile
+// stores and restores only its own points.
+struct GeometryEntry {
+  int generation{0};
+  // Origins of the tiles whose geometry is stored
+  std::set<std::array<int, dim>> tiles;
+  amrex::Gpu::DeviceVector<CCTK_REAL> vdata, cdata;
+};
+
+std::map<GeometryKey, GeometryEntry> g_geometry_cache;
+
+// Incremented before each (re)grid. Entries that were not touched since are
+// stale.
+int g_geometry_generation = 0;
+
+} // namespace
 
 extern "C" int CurvBase_MultiPatch_Setup() {
   DECLARE_CCTK_PARAMETERS;
 
-  if (g_active_mp == nullptr) {
-    void *ptr = amrex::The_Managed_Arena()->alloc(sizeof(AMP));
+  if (g_multipatch == nullptr)
+    g_multipatch = std::make_unique<MultiPatch>();
 
-    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-        ptr != nullptr, "Managed-arena allocation of MultiPatch failed");
+  MultiPatch *const mp = g_multipatch.get();
 
-    new (ptr) AMP(); // construct the object in the allocated memory using
-                     // placement new.
-    g_active_mp = static_cast<AMP *>(ptr);
-  }
+  Symmetry sym = Symmetry::none;
+  if (CCTK_EQUALS(symmetry, "bitant"))
+    sym = Symmetry::bitant;
+  else if (CCTK_EQUALS(symmetry, "quadrant"))
+    sym = Symmetry::quadrant;
+  else if (CCTK_EQUALS(symmetry, "octant"))
+    sym = Symmetry::octant;
 
-  auto mp = active_mp();
+  if (sym != Symmetry::none && !CCTK_EQUALS(patch_system, "Spherical") &&
+      !CCTK_EQUALS(patch_system, "CubedSphere"))
+    CCTK_VERROR("Symmetry \"%s\" is not supported by the patch system \"%s\"",
+                symmetry, patch_system);
 
   if (CCTK_EQUALS(patch_system, "Cartesian")) {
     Index ncells{cartesian_ncells_i, cartesian_ncells_j, cartesian_ncells_k};
@@ -39,7 +100,7 @@ extern "C" int CurvBase_MultiPatch_Setup() {
     std::array<bool, dim> cutouts{spherical_cutout_r != 0,
                                   spherical_cutout_th != 0,
                                   spherical_cutout_ph != 0};
-    mp->select_spherical(ncells, xmin, xmax, cutouts);
+    mp->select_spherical(ncells, xmin, xmax, cutouts, sym);
   } else if (CCTK_EQUALS(patch_system, "Cylindrical")) {
     Index ncells{cylindrical_ncells_rh, cylindrical_ncells_ph,
                  cylindrical_ncells_z};
@@ -51,7 +112,7 @@ extern "C" int CurvBase_MultiPatch_Setup() {
     Coord xmin{-1.0, -1.0, -1.0};
     Coord xmax{1.0, 1.0, 1.0};
     mp->select_cubedsphere(ncells, xmin, xmax, cubedsphere_rmin,
-                           cubedsphere_rmax);
+                           cubedsphere_rmax, sym);
   } else {
     CCTK_VERROR("Unknown multi-patch system \"%s\"", patch_system);
   }
@@ -60,17 +121,100 @@ extern "C" int CurvBase_MultiPatch_Setup() {
 }
 
 extern "C" void CurvBase_MultiPatch_Finalize(CCTK_ARGUMENTS) {
-  if (g_active_mp) {
-    g_active_mp->~AMP();
-    amrex::The_Managed_Arena()->free(g_active_mp);
-    g_active_mp = nullptr;
+  // Device memory has to be released before AMReX shuts down
+  g_geometry_cache.clear();
+  g_multipatch.reset();
+}
+
+extern "C" void CurvBase_MultiPatch_Geometry_BeginRegrid(CCTK_ARGUMENTS) {
+  ++g_geometry_generation;
+}
+
+extern "C" void CurvBase_MultiPatch_Geometry_Prune(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_CurvBase_MultiPatch_Geometry_Prune;
+  DECLARE_CCTK_PARAMETERS;
+
+  std::size_t npruned = 0;
+  for (auto it = g_geometry_cache.begin(); it != g_geometry_cache.end();) {
+    if (it->second.generation != g_geometry_generation) {
+      it = g_geometry_cache.erase(it);
+      ++npruned;
+    } else {
+      ++it;
+    }
   }
+
+  if (verbose)
+    CCTK_VINFO("Geometry cache: %zu boxes, %zu pruned",
+               g_geometry_cache.size(), npruned);
 }
 
 extern "C" void CurvBase_MultiPatch_Coordinates_Setup(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTSX_CurvBase_MultiPatch_Coordinates_Setup;
   DECLARE_CCTK_PARAMETERS;
 
+  const std::array<GF3D2<CCTK_REAL>, nvgeom> vgfs{vcoordx, vcoordy, vcoordz};
+  const std::array<GF3D2<CCTK_REAL>, ncgeom> cgfs{
+      ccoordx, ccoordy, ccoordz, cvol,   cmask,  cJ1x,   cJ1y,   cJ1z,
+      cJ2x,    cJ2y,    cJ2z,    cJ3x,   cJ3y,   cJ3z,   cdJ1xx, cdJ1xy,
+      cdJ1xz,  cdJ1yy,  cdJ1yz,  cdJ1zz, cdJ2xx, cdJ2xy, cdJ2xz, cdJ2yy,
+      cdJ2yz,  cdJ2zz,  cdJ3xx,  cdJ3xy, cdJ3xz, cdJ3yy, cdJ3yz, cdJ3zz};
+
+  const GF3D2layout vlayout(cctkGH, {0, 0, 0});
+  const GF3D2layout clayout(cctkGH, {1, 1, 1});
+  const int *const lsh = cctkGH->cctk_lsh;
+  const int nv = vlayout.linear(lsh[0] - 1, lsh[1] - 1, lsh[2] - 1) + 1;
+  const int nc = clayout.linear(lsh[0] - 2, lsh[1] - 2, lsh[2] - 2) + 1;
+
+  GeometryEntry *entry = nullptr;
+  bool cached = false;
+  if (cache_geometry) {
+    const int level = ilogb(cctkGH->cctk_levfac[0]);
+    GeometryKey key{grid.patch, level, {}, {}};
+    std::array<int, dim> tile;
+    for (int d = 0; d < dim; ++d) {
+      key.lbnd[d] = cctkGH->cctk_lbnd[d];
+      key.lsh[d] = lsh[d];
+      tile[d] = grid.tmin[d];
+    }
+#pragma omp critical(CurvBase_MultiPatch_GeometryCache)
+    {
+      entry = &g_geometry_cache[key];
+      // The first tile of a new box allocates the storage of the whole box,
+      // before any tile of the box writes to it
+      if (entry->generation == 0) {
+        entry->vdata.resize(nvgeom * nv);
+        entry->cdata.resize(ncgeom * nc);
+      }
+      entry->generation = g_geometry_generation;
+      cached = !entry->tiles.insert(tile).second;
+    }
+  }
+
+  // Unchanged tile: restore its geometry instead of recomputing it. This is
+  // a device copy of all geometry components, so the cost of a regrid still
+  // scales with the volume of the grid, but it avoids evaluating the patch
+  // maps and their derivatives.
+  if (cached) {
+    const CCTK_REAL *const vbuf = entry->vdata.data();
+    const CCTK_REAL *const cbuf = entry->cdata.data();
+    grid.loop_all_device<0, 0, 0>(
+        grid.nghostzones,
+        [=] ARITH_DEVICE(const Loop::PointDesc &p) ARITH_INLINE {
+          const int ijk = vlayout.linear(p.i, p.j, p.k);
+          for (int c = 0; c < nvgeom; ++c)
+            vgfs[c](p.I) = vbuf[c * nv + ijk];
+        });
+    grid.loop_all_device<1, 1, 1>(
+        grid.nghostzones,
+        [=] ARITH_DEVICE(const Loop::PointDesc &p) ARITH_INLINE {
+          const int ijk = clayout.linear(p.i, p.j, p.k);
+          for (int c = 0; c < ncgeom; ++c)
+            cgfs[c](p.I) = cbuf[c * nc + ijk];
+        });
+    return;
+  }
+
   // access active multipatch system
   auto mp = active_mp();
 
@@ -78,7 +222,7 @@ extern "C" void CurvBase_MultiPatch_Coordinates_Setup(CCTK_ARGUMENTS) {
                                 [=] ARITH_DEVICE(const Loop::PointDesc &p)
                                     ARITH_INLINE {
                                       const Coord l = {p.x, p.y, p.z};
-                                      const Coord g = mp->l2g(p.patch, l);
+                                      const Coord g = mp.l2g(p.patch, l);
 
                                       vcoordx(p.I) = g[0];
                                       vcoordy(p.I) = g[1];
@@ -89,14 +233,32 @@ extern "C" void CurvBase_MultiPatch_Coordinates_Setup(CCTK_ARGUMENTS) {
       grid.nghostzones,
       [=] ARITH_DEVICE(const Loop::PointDesc &p) ARITH_INLINE {
         const Coord l = {p.x, p.y, p.z};
-        const Coord g = mp->l2g(p.patch, l);
+        const Coord g = mp.l2g(p.patch, l);
 
         ccoordx(p.I) = g[0];
         ccoordy(p.I) = g[1];
         ccoordz(p.I) = g[2];
 
-        const Jac_t jac = mp->jac_g2l_l(p.patch, l);
-        const dJac_t djac = mp->djac_g2l_l(p.patch, l);
+        const Jac_t jac = mp.jac_g2l_l(p.patch, l);
+        const dJac_t djac = mp.djac_g2l_l(p.patch, l);
+
+        // Physical cell volume |det(dx^i/dr^j)| dr dtheta dphi, where the
+        // Jacobian stored here is dr^i/dx^j. This is infinite on CubedSphere
+        // wedges, whose Jacobians are still zero; VolumeReduction rejects
+        // them.
+        const CCTK_REAL detJ =
+            jac[0][0] * (jac[1][1] * jac[2][2] - jac[1][2] * jac[2][1]) -
+            jac[0][1] * (jac[1][0] * jac[2][2] - jac[1][2] * jac[2][0]) +
+            jac[0][2] * (jac[1][0] * jac[2][1] - jac[1][1] * jac[2][0]);
+        cvol(p.I) = p.dx * p.dy * p.dz / std::fabs(detJ);
+
+        // Where patches overlap, a cell only counts in the first patch
+        // containing it
+        const std::size_t owner = mp.owner(g);
+        cmask(p.I) = (owner != MultiPatchView::invalid_patch_id &&
+                      owner < static_cast<std::size_t>(p.patch))
+                         ? 0
+                         : 1;
 
         // e^r_x = dr^i/dx^j
         cJ1x(p.I) = jac[0][0];
@@ -129,6 +291,26 @@ extern "C" void CurvBase_MultiPatch_Coordinates_Setup(CCTK_ARGUMENTS) {
         cdJ3yz(p.I) = djac[2][4];
         cdJ3zz(p.I) = djac[2][5];
       });
+
+  // New or changed box: keep the geometry of this tile for later regrids
+  if (entry != nullptr) {
+    CCTK_REAL *const vbuf = entry->vdata.data();
+    CCTK_REAL *const cbuf = entry->cdata.data();
+    grid.loop_all_device<0, 0, 0>(
+        grid.nghostzones,
+        [=] ARITH_DEVICE(const Loop::PointDesc &p) ARITH_INLINE {
+          const int ijk = vlayout.linear(p.i, p.j, p.k);
+          for (int c = 0; c < nvgeom; ++c)
+            vbuf[c * nv + ijk] = vgfs[c](p.I);
+        });
+    grid.loop_all_device<1, 1, 1>(
+        grid.nghostzones,
+        [=] ARITH_DEVICE(const Loop::PointDesc &p) ARITH_INLINE {
+          const int ijk = clayout.linear(p.i, p.j, p.k);
+          for (int c = 0; c < ncgeom; ++c)
+            cbuf[c * nc + ijk] = cgfs[c](p.I);
+        });
+  }
 }
 
 //==============================================================================
@@ -137,7 +319,7 @@ extern "C" void CurvBase_MultiPatch_Coordinates_Setup(CCTK_ARGUMENTS) {
 
 extern "C" CCTK_INT
 CurvBase_MultiPatch_GetSystemSpecification(CCTK_INT *restrict const npatches) {
-  *npatches = static_cast<CCTK_INT>(active_mp()->size());
+  *npatches = static_cast<CCTK_INT>(multipatch().size());
   return 0;
 }
 
@@ -145,12 +327,12 @@ extern "C" CCTK_INT CurvBase_MultiPatch_GetPatchSpecification(
     const CCTK_INT ipatch, CCTK_INT *restrict const is_cartesian,
     const CCTK_INT size, CCTK_INT *restrict const ncells,
     CCTK_REAL *restrict const xmin, CCTK_REAL *restrict const xmax) {
-  auto mp = active_mp();
+  const MultiPatch &mp = multipatch();
 
   assert(size == dim);
-  assert(ipatch >= 0 && ipatch < static_cast<CCTK_INT>(mp->size()));
+  assert(ipatch >= 0 && ipatch < static_cast<CCTK_INT>(mp.size()));
 
-  const Patch *patch = mp->get_patch(static_cast<std::size_t>(ipatch));
+  const Patch *patch = mp.get_patch(static_cast<std::size_t>(ipatch));
   assert(patch != nullptr);
 
   if (is_cartesian != nullptr) {
@@ -169,12 +351,12 @@ extern "C" CCTK_INT CurvBase_MultiPatch_GetPatchSpecification(
 extern "C" CCTK_INT CurvBase_MultiPatch_GetBoundarySpecification(
     const CCTK_INT ipatch, const CCTK_INT size,
     CCTK_INT *restrict const is_interpatch_boundary) {
-  auto mp = active_mp();
+  const MultiPatch &mp = multipatch();
 
   assert(size == 2 * dim);
-  assert(ipatch >= 0 && ipatch < static_cast<CCTK_INT>(mp->size()));
+  assert(ipatch >= 0 && ipatch < static_cast<CCTK_INT>(mp.size()));
 
-  const Patch *patch = mp->get_patch(static_cast<std::size_t>(ipatch));
+  const Patch *patch = mp.get_patch(static_cast<std::size_t>(ipatch));
   assert(patch != nullptr);
 
   for (int d = 0; d < dim; ++d) {
@@ -193,10 +375,13 @@ extern "C" void CurvBase_MultiPatch_GlobalToLocal(
     const CCTK_REAL *restrict const globalsz, CCTK_INT *restrict const patches,
     CCTK_REAL *restrict const localsx, CCTK_REAL *restrict const localsy,
     CCTK_REAL *restrict const localsz) {
-  const auto mp = active_mp();
+  const MultiPatch &multi = multipatch();
+  const MultiPatchView mp = multi.host_view();
   for (int n = 0; n < npoints; ++n) {
-    const std::array<CCTK_REAL, dim> x{globalsx[n], globalsy[n], globalsz[n]};
-    const auto [l, patch_id] = mp->g2l(x);
+    // Points across a symmetry plane are looked up at their mirror image.
+    // Their parity is restored when the symmetry ghost zones are filled.
+    const Coord x = multi.reflect({globalsx[n], globalsy[n], globalsz[n]});
+    const auto [l, patch_id] = mp.g2l(x);
     patches[n] = static_cast<CCTK_INT>(patch_id);
     localsx[n] = l[0];
     localsy[n] = l[1];
@@ -3,173 +3,488 @@
 
 /**
  * @file
- * @brief Defines the MultiPatch container and the global instance for the
- * system.
+ * @brief Defines the MultiPatch container, its flattened patch table, and the
+ * global instance for the system.
  */
 
 #include <AMReX_Gpu.H>
+#include <AMReX_GpuContainers.H>
 
-#include <variant>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 
 #include "CurvBase_Patch.hxx"
 
 namespace CurvBase {
 
 //==============================================================================
-// MultiPatch Definition
+// Flattened Patch Table
 //==============================================================================
 
 /**
- * @brief Manages a collection of Patches for a composite grid geometry.
+ * @brief Structure-of-arrays storage of the patches of a multipatch system.
+ *
+ * Each field of `Patch` is stored in its own contiguous array, so that device
+ * threads only touch the fields they need (typically `type` and `meta`).
  *
- * This class serves two primary roles:
- * 1. A container for a fixed-size array of `Patch` objects, providing
- * device-callable coordinate transformations between local and global frames.
- * 2. A host-side factory for building specific, pre-defined grid
- * configurations (e.g., Cartesian, Cubed-Sphere).
+ * @tparam Vector The container, e.g. a host or a device vector.
+ */
+template <template <class> class Vector> struct PatchTable {
+  Vector<PatchType> type;
+  Vector<MetaUnion> meta;
+  Vector<Index> ncells;
+  Vector<Coord> xmin, xmax, dx;
+  Vector<PatchFaces> faces;
+};
+
+template <class T> using HostVector = std::vector<T>;
+template <class T> using DeviceVector = amrex::Gpu::DeviceVector<T>;
+
+/**
+ * @brief Non-owning, trivially copyable view of a patch table.
  *
- * @tparam MaxP The maximum number of patches this container can hold.
+ * Device kernels capture the view by value, so the handful of pointers travel
+ * as kernel arguments while the table itself sits in device global memory.
  */
-template <std::size_t MaxP> class MultiPatch {
-  Patch patches_[MaxP]{};
+class MultiPatchView {
   std::size_t count_{0};
+  const PatchType *type_{nullptr};
+  const MetaUnion *meta_{nullptr};
+  const Index *ncells_{nullptr};
+  const Coord *xmin_{nullptr}, *xmax_{nullptr}, *dx_{nullptr};
+  const PatchFaces *faces_{nullptr};
 
   static constexpr Coord invalid_coord = {
       std::numeric_limits<CCTK_REAL>::quiet_NaN(),
       std::numeric_limits<CCTK_REAL>::quiet_NaN(),
       std::numeric_limits<CCTK_REAL>::quiet_NaN()};
-  static constexpr std::size_t invalid_patch_id = static_cast<std::size_t>(-1);
 
 public:
-  CCTK_HOST MultiPatch() = default;
+  static constexpr std::size_t invalid_patch_id = static_cast<std::size_t>(-1);
+
+  CCTK_HOST CCTK_DEVICE MultiPatchView() = default;
 
-  CCTK_HOST void clear() noexcept { count_ = 0; }
+  template <template <class> class Vector>
+  CCTK_HOST explicit MultiPatchView(const PatchTable<Vector> &table)
+      : count_{table.type.size()}, type_{table.type.data()},
+        meta_{table.meta.data()}, ncells_{table.ncells.data()},
+        xmin_{table.xmin.data()}, xmax_{table.xmax.data()},
+        dx_{table.dx.data()}, faces_{table.faces.data()} {}
 
-  CCTK_HOST bool add_patch(const Patch &p) {
-    if (count_ >= MaxP)
-      return false;
-    patches_[count_++] = p;
-    return true;
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE std::size_t size() const noexcept {
+    return count_;
   }
 
-  [[nodiscard]] CCTK_HOST CCTK_DEVICE const Patch *
-  get_patch(std::size_t id) const noexcept {
-    return (id < count_) ? &patches_[id] : nullptr;
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE PatchType
+  type(std::size_t id) const noexcept {
+    return type_[id];
   }
 
-  [[nodiscard]] CCTK_HOST CCTK_DEVICE std::size_t size() const noexcept {
-    return count_;
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE const Index &
+  ncells(std::size_t id) const noexcept {
+    return ncells_[id];
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE const Coord &
+  xmin(std::size_t id) const noexcept {
+    return xmin_[id];
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE const Coord &
+  xmax(std::size_t id) const noexcept {
+    return xmax_[id];
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE const Coord &
+  dx(std::size_t id) const noexcept {
+    return dx_[id];
+  }
+
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE const PatchFaces &
+  faces(std::size_t id) const noexcept {
+    return faces_[id];
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE Coord l2g(std::size_t id,
                                                 const Coord &l) const noexcept {
-    return (id < count_) ? patches_[id].l2g(l) : invalid_coord;
+    return (id < count_) ? patch_l2g(type_[id], meta_[id], l) : invalid_coord;
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE std::pair<Coord, std::size_t>
   g2l(const Coord &g) const noexcept {
     for (std::size_t i = 0; i < count_; ++i) {
-      const auto &p = patches_[i];
+      const PatchType t = type_[i];
+      const MetaUnion &m = meta_[i];
 
       // TODO: Includes AABB check to quickly discard non-overlapping patches.
-      // if (g[0] < p.g_xmin[0] || g[0] > p.g_xmax[0] || g[1] < p.g_xmin[1] ||
-      //     g[1] > p.g_xmax[1] || g[2] < p.g_xmin[2] || g[2] > p.g_xmax[2]) {
-      //   continue;
-      // }
 
-      const Coord loc = p.g2l(g);
-      if (p.is_valid(loc)) {
+      const Coord loc = patch_g2l(t, m, g);
+      if (patch_is_valid(t, m, loc)) {
         return {loc, i};
       }
     }
     return {invalid_coord, invalid_patch_id};
   }
 
+  /**
+   * @brief The first patch whose domain contains a global point.
+   *
+   * Unlike `g2l`, the local coordinates have to lie within the patch bounds
+   * and map back onto the point, so that patches whose coordinate maps are
+   * also defined outside their domain are not mistaken for owners. Patches
+   * that overlap are thus ranked by their id.
+   */
+  [[nodiscard]] CCTK_HOST CCTK_DEVICE std::size_t
+  owner(const Coord &g) const noexcept {
+    constexpr CCTK_REAL tol = 1.0e-12;
+    const CCTK_REAL scale =
+        CCTK_REAL{1} + std::fabs(g[0]) + std::fabs(g[1]) + std::fabs(g[2]);
+    for (std::size_t i = 0; i < count_; ++i) {
+      const PatchType t = type_[i];
+      const MetaUnion &m = meta_[i];
+
+      const Coord loc = patch_g2l(t, m, g);
+      bool inside = patch_is_valid(t, m, loc);
+      for (int d = 0; d < dim; ++d) {
+        const CCTK_REAL eps = tol * (xmax_[i][d] - xmin_[i][d]);
+        inside &= loc[d] >= xmin_[i][d] - eps && loc[d] <= xmax_[i][d] + eps;
+      }
+      if (!inside)
+        continue;
+
+      const Coord back = patch_l2g(t, m, loc);
+      if (std::fabs(back[0] - g[0]) + std::fabs(back[1] - g[1]) +
+              std::fabs(back[2] - g[2]) <=
+          1.0e-10 * scale)
+        return i;
+    }
+    return invalid_patch_id;
+  }
+
   [[nodiscard]] CCTK_HOST CCTK_DEVICE Jac_t
   jac_g2l_l(std::size_t id, const Coord &l) const noexcept {
-    return patches_[id].jac_g2l_l(l);
+    return patch_jac_g2l_l(type_[id], meta_[id], l);
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE dJac_t
   djac_g2l_l(std::size_t id, const Coord &l) const noexcept {
-    return patches_[id].djac_g2l_l(l);
+    return patch_djac_g2l_l(type_[id], meta_[id], l);
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE Jac_t
   jac_g2l_g(std::size_t id, const Coord &g) const noexcept {
-    return patches_[id].jac_g2l_g(g);
+    return patch_jac_g2l_g(type_[id], meta_[id], g);
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE dJac_t
   djac_g2l_g(std::size_t id, const Coord &g) const noexcept {
-    return patches_[id].djac_g2l_g(g);
+    return patch_djac_g2l_g(type_[id], meta_[id], g);
   }
+};
 
-  // --- Host-Side Factory Methods ---
+static_assert(std::is_trivially_copyable_v<MultiPatchView>,
+              "MultiPatchView is captured by value in device kernels");
 
-  CCTK_HOST void select_cartesian(Index ncells, Coord xmin, Coord xmax) {
-    clear();
+//==============================================================================
+// MultiPatch Builder
+//==============================================================================
+
+/**
+ * @brief Host-side composition of an arbitrary set of patches.
+ *
+ * Patches are appended in order; a patch's id is its position. The preset
+ * helpers append the patches of one of the standard systems, so that e.g.
+ * several cubed spheres and a Cartesian background can be combined.
+ */
+class MultiPatchBuilder {
+  std::vector<Patch> patches_;
+  int symmetry_planes_{0};
+
+  // Restrict direction d of a patch to [lo, hi] at unchanged resolution
+  CCTK_HOST static void restrict_range(Index &ncells, Coord &xmin, Coord &xmax,
+                                       int d, CCTK_REAL lo, CCTK_REAL hi) {
+    const CCTK_REAL dx = (xmax[d] - xmin[d]) / ncells[d];
+    const CCTK_REAL n = (hi - lo) / dx;
+    if (std::fabs(n - std::round(n)) > 1.0e-8 ||
+        std::fabs((lo - xmin[d]) / dx - std::round((lo - xmin[d]) / dx)) >
+            1.0e-8)
+      CCTK_VERROR("Symmetry: cannot restrict direction %d from [%g, %g] with "
+                  "%d cells to [%g, %g] at the same resolution",
+                  d, double(xmin[d]), double(xmax[d]), int(ncells[d]),
+                  double(lo), double(hi));
+    ncells[d] = static_cast<CCTK_INT>(std::lround(n));
+    xmin[d] = lo;
+    xmax[d] = hi;
+  }
+
+public:
+  CCTK_HOST MultiPatchBuilder &add_patch(const Patch &p) {
+    patches_.push_back(p);
+    return *this;
+  }
+
+  template <class MetaT, class... MetaArgs>
+  CCTK_HOST MultiPatchBuilder &add(Index ncells, Coord xmin, Coord xmax,
+                                   const PatchFaces &faces,
+                                   MetaArgs &&...meta_args) {
+    return add_patch(make_patch<MetaT>(ncells, xmin, xmax, faces,
+                                       std::forward<MetaArgs>(meta_args)...));
+  }
+
+  [[nodiscard]] CCTK_HOST std::size_t size() const noexcept {
+    return patches_.size();
+  }
+
+  [[nodiscard]] CCTK_HOST const std::vector<Patch> &patches() const noexcept {
+    return patches_;
+  }
+
+  /// Union of the symmetry planes of the presets that were added
+  [[nodiscard]] CCTK_HOST int symmetry_planes() const noexcept {
+    return symmetry_planes_;
+  }
+
+  // --- Presets ---
+
+  CCTK_HOST MultiPatchBuilder &add_cartesian(Index ncells, Coord xmin,
+                                             Coord xmax) {
     const PatchFaces faces = {{{outer_face, outer_face, outer_face},
                                {outer_face, outer_face, outer_face}}};
-    assert(add_patch(make_patch<CartesianMeta>(ncells, xmin, xmax, faces)) &&
-           "Exceeded MaxP patches");
+    return add<CartesianMeta>(ncells, xmin, xmax, faces);
   }
 
-  CCTK_HOST void select_spherical(Index ncells, Coord xmin, Coord xmax,
-                                  std::array<bool, dim> cutouts) {
-    clear();
+  /// The ranges and numbers of cells describe the full sphere; a symmetry
+  /// restricts them to the fundamental domain
+  CCTK_HOST MultiPatchBuilder &
+  add_spherical(Index ncells, Coord xmin, Coord xmax,
+                std::array<bool, dim> cutouts,
+                Symmetry symmetry = Symmetry::none) {
     FaceInfo rmin_face = (cutouts[0]) ? outer_face : inner_face;
     FaceInfo rmax_face = outer_face;
     FaceInfo thmin_face = (cutouts[1]) ? outer_face : inner_face;
     FaceInfo thmax_face = (cutouts[1]) ? outer_face : inner_face;
     FaceInfo phmin_face = (cutouts[2]) ? outer_face : inner_face;
     FaceInfo phmax_face = (cutouts[2]) ? outer_face : inner_face;
+
+    const int planes = static_cast<int>(symmetry);
+    if (planes & (sym_x | sym_y)) {
+      // phi in [0, pi/2]: phi = 0 lies in the plane y = 0, phi = pi/2 in the
+      // plane x = 0. Mirroring through the axis maps phi to phi + pi, which
+      // is a reflection in both x and y.
+      restrict_range(ncells, xmin, xmax, 2, 0, onepi / 2);
+      phmin_face = symmetry_face(sym_y);
+      phmax_face = symmetry_face(sym_x);
+      thmin_face = symmetry_face(sym_x | sym_y);
+      thmax_face = symmetry_face(sym_x | sym_y);
+    }
+    if (planes & sym_z) {
+      // theta in [0, pi/2]: the equator lies in the plane z = 0
+      restrict_range(ncells, xmin, xmax, 1, 0, onepi / 2);
+      thmax_face = symmetry_face(sym_z);
+    }
+    symmetry_planes_ |= planes;
+
     const PatchFaces faces = {{{rmin_face, thmin_face, phmin_face},
                                {rmax_face, thmax_face, phmax_face}}};
-    assert(add_patch(make_patch<SphericalMeta>(ncells, xmin, xmax, faces)) &&
-           "Exceeded MaxP patches");
+    return add<SphericalMeta>(ncells, xmin, xmax, faces);
   }
 
-  CCTK_HOST void select_cylindrical(Index ncells, Coord xmin, Coord xmax) {
-    clear();
+  CCTK_HOST MultiPatchBuilder &add_cylindrical(Index ncells, Coord xmin,
+                                               Coord xmax) {
     const PatchFaces faces = {{{inner_face, inner_face, outer_face},
                                {outer_face, inner_face, outer_face}}};
-    assert(add_patch(make_patch<CylindricalMeta>(ncells, xmin, xmax, faces)) &&
-           "Exceeded MaxP patches");
+    return add<CylindricalMeta>(ncells, xmin, xmax, faces);
   }
 
-  CCTK_HOST void select_cubedsphere(Index ncells, Coord xmin, Coord xmax,
-                                    CCTK_REAL r0, CCTK_REAL r1) {
-    clear();
-    static_assert(MaxP >= 7, "MaxP must be at least 7 for CubedSphere");
-    const PatchFaces central_faces = {{{inner_face, inner_face, inner_face},
-                                       {inner_face, inner_face, inner_face}}};
+  /// With a symmetry, the wedges on the negative side of a symmetry plane are
+  /// dropped, and the central cube and the wedges crossing a symmetry plane
+  /// are halved
+  CCTK_HOST MultiPatchBuilder &
+  add_cubedsphere(Index ncells, Coord xmin, Coord xmax, CCTK_REAL r0,
+                  CCTK_REAL r1, Symmetry symmetry = Symmetry::none) {
+    PatchFaces central_faces = {{{inner_face, inner_face, inner_face},
+                                 {inner_face, inner_face, inner_face}}};
     const PatchFaces wedge_faces = {{{inner_face, inner_face, inner_face},
                                      {inner_face, inner_face, outer_face}}};
 
-    assert(add_patch(
-               make_patch<CartesianMeta>(ncells, xmin, xmax, central_faces)) &&
-           "Exceeded MaxP");
+    const int planes = static_cast<int>(symmetry);
+
+    Index central_ncells = ncells;
+    Coord central_xmin = xmin, central_xmax = xmax;
+    for (int d = 0; d < dim; ++d) {
+      if (planes & (1 << d)) {
+        restrict_range(central_ncells, central_xmin, central_xmax, d, 0,
+                       xmax[d]);
+        central_faces[0][d] = symmetry_face(1 << d);
+      }
+    }
+    add<CartesianMeta>(central_ncells, central_xmin, central_xmax,
+                       central_faces);
+
+    // Cartesian axis and sign of the wedge normal, and of the Cartesian
+    // coordinates proportional to xi and eta (see cubedspherewedge_l2g)
+    static constexpr int normal_axis[6] = {0, 0, 1, 1, 2, 2};
+    static constexpr int normal_sign[6] = {+1, -1, +1, -1, +1, -1};
+    static constexpr int tangent_axis[6][2] = {{1, 2}, {1, 2}, {0, 2},
+                                               {0, 2}, {0, 1}, {0, 1}};
+    static constexpr int tangent_sign[6][2] = {{+1, +1}, {-1, +1}, {-1, +1},
+                                               {+1, +1}, {+1, +1}, {+1, -1}};
 
     for (const auto w :
          {Wedge::PX, Wedge::NX, Wedge::PY, Wedge::NY, Wedge::PZ, Wedge::NZ}) {
-      assert(add_patch(make_patch<CubedSphereWedgeMeta>(
-                 ncells, xmin, xmax, wedge_faces, w, r0, r1)) &&
-             "Exceeded MaxP patches");
+      const int f = static_cast<int>(w);
+      if ((planes & (1 << normal_axis[f])) && normal_sign[f] < 0)
+        continue;
+
+      Index wedge_ncells = ncells;
+      Coord wedge_xmin = xmin, wedge_xmax = xmax;
+      PatchFaces faces = wedge_faces;
+      for (int d = 0; d < 2; ++d) {
+        const int plane = 1 << tangent_axis[f][d];
+        if (!(planes & plane))
+          continue;
+        // The plane is at xi = 0 (or eta = 0); keep the side that maps to
+        // the positive Cartesian coordinate
+        if (tangent_sign[f][d] > 0) {
+          restrict_range(wedge_ncells, wedge_xmin, wedge_xmax, d, 0,
+                         xmax[d]);
+          faces[0][d] = symmetry_face(plane);
+        } else {
+          restrict_range(wedge_ncells, wedge_xmin, wedge_xmax, d, xmin[d],
+                         0);
+          faces[1][d] = symmetry_face(plane);
+        }
+      }
+      add<CubedSphereWedgeMeta>(wedge_ncells, wedge_xmin, wedge_xmax, faces,
+                                w, r0, r1);
     }
+    symmetry_planes_ |= planes;
+
+    return *this;
   }
 };
 
 //==============================================================================
-// Global Multipatch Instance
+// MultiPatch Definition
 //==============================================================================
 
-constexpr std::size_t MAX_PATCHES = 10;
-using AMP = MultiPatch<MAX_PATCHES>;
+/**
+ * @brief Owns a multipatch system on the host and mirrors it to the device.
+ *
+ * The patches are kept as an array of `Patch` objects for host-side queries,
+ * and flattened into a `PatchTable` in host and device memory. There is no
+ * compile-time limit on the number of patches.
+ */
+class MultiPatch {
+  std::vector<Patch> patches_;
+  int symmetry_planes_{0};
+  PatchTable<HostVector> host_table_;
+  PatchTable<DeviceVector> device_table_;
+
+  template <class T, class F>
+  CCTK_HOST static void upload(HostVector<T> &h, DeviceVector<T> &d,
+                               const std::vector<Patch> &patches, F field) {
+    h.resize(patches.size());
+    for (std::size_t i = 0; i < patches.size(); ++i)
+      h[i] = field(patches[i]);
+    d.resize(h.size());
+    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h.begin(), h.end(),
+                          d.begin());
+  }
+
+public:
+  CCTK_HOST MultiPatch() = default;
+
+  /// Replace the patches and rebuild the host and device tables
+  CCTK_HOST void assign(std::vector<Patch> patches, int symmetry_planes = 0) {
+    patches_ = std::move(patches);
+    symmetry_planes_ = symmetry_planes;
+
+    auto &h = host_table_;
+    auto &d = device_table_;
+    upload(h.type, d.type, patches_, [](const Patch &p) { return p.type; });
+    upload(h.meta, d.meta, patches_, [](const Patch &p) { return p.meta; });
+    upload(h.ncells, d.ncells, patches_,
+           [](const Patch &p) { return p.ncells; });
+    upload(h.xmin, d.xmin, patches_, [](const Patch &p) { return p.xmin; });
+    upload(h.xmax, d.xmax, patches_, [](const Patch &p) { return p.xmax; });
+    upload(h.dx, d.dx, patches_, [](const Patch &p) { return p.dx; });
+    upload(h.faces, d.faces, patches_, [](const Patch &p) { return p.faces; });
+    amrex::Gpu::streamSynchronize();
+  }
+
+  CCTK_HOST void assign(const MultiPatchBuilder &builder) {
+    assign(builder.patches(), builder.symmetry_planes());
+  }
+
+  [[nodiscard]] CCTK_HOST const Patch *
+  get_patch(std::size_t id) const noexcept {
+    return (id < patches_.size()) ? &patches_[id] : nullptr;
+  }
+
+  [[nodiscard]] CCTK_HOST std::size_t size() const noexcept {
+    return patches_.size();
+  }
+
+  /// Bit mask of the reflection symmetry planes, see `SymmetryPlane`
+  [[nodiscard]] CCTK_HOST int symmetry_planes() const noexcept {
+    return symmetry_planes_;
+  }
+
+  /// Map a global point into the fundamental domain of the symmetries
+  [[nodiscard]] CCTK_HOST Coord reflect(Coord g) const noexcept {
+    for (int d = 0; d < dim; ++d)
+      if (symmetry_planes_ & (1 << d))
+        g[d] = std::fabs(g[d]);
+    return g;
+  }
+
+  /// View of the table in device memory, for use in device kernels
+  [[nodiscard]] CCTK_HOST MultiPatchView device_view() const {
+    return MultiPatchView(device_table_);
+  }
+
+  /// View of the table in host memory, for use in host loops
+  [[nodiscard]] CCTK_HOST MultiPatchView host_view() const {
+    return MultiPatchView(host_table_);
+  }
+
+  // --- Host-Side Factory Methods ---
+
+  CCTK_HOST void select_cartesian(Index ncells, Coord xmin, Coord xmax) {
+    assign(MultiPatchBuilder().add_cartesian(ncells, xmin, xmax));
+  }
+
+  CCTK_HOST void select_spherical(Index ncells, Coord xmin, Coord xmax,
+                                  std::array<bool, dim> cutouts,
+                                  Symmetry symmetry = Symmetry::none) {
+    assign(MultiPatchBuilder().add_spherical(ncells, xmin, xmax, cutouts,
+                                             symmetry));
+  }
+
+  CCTK_HOST void select_cylindrical(Index ncells, Coord xmin, Coord xmax) {
+    assign(MultiPatchBuilder().add_cylindrical(ncells, xmin, xmax));
+  }
+
+  CCTK_HOST void select_cubedsphere(Index ncells, Coord xmin, Coord xmax,
+                                    CCTK_REAL r0, CCTK_REAL r1,
+                                    Symmetry symmetry = Symmetry::none) {
+    assign(MultiPatchBuilder().add_cubedsphere(ncells, xmin, xmax, r0, r1,
+                                               symmetry));
+  }
+};
+
+//==============================================================================
+// Global Multipatch Instance
+//==============================================================================
 
-extern AMREX_GPU_MANAGED AMP *g_active_mp;
+/// The active multipatch system (host side)
+CCTK_HOST MultiPatch &multipatch();
 
-CCTK_HOST CCTK_DEVICE AMP *active_mp();
+/// Device view of the active multipatch system, to be captured by kernels
+CCTK_HOST MultiPatchView active_mp();
 
 } // namespace CurvBase
 
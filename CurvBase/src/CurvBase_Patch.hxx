@@ -53,6 +53,149 @@ static_assert(
     std::is_trivially_copyable_v<MetaUnion>,
     "MetaUnion must stay POD so the whole Patch is trivially copyable");
 
+/**
+ * @brief Dispatches on the patch type to the matching coordinate metadata.
+ *
+ * Free-standing so that it works both on a `Patch` and on the flattened
+ * per-field patch table used on the device.
+ */
+template <typename Visitor>
+[[nodiscard]]
+CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr decltype(auto)
+visit_meta(const PatchType type, const MetaUnion &meta, Visitor &&visitor) {
+  switch (type) {
+  case PatchType::Cartesian:
+    return std::forward<Visitor>(visitor)(meta.cart);
+  case PatchType::Spherical:
+    return std::forward<Visitor>(visitor)(meta.sph);
+  case PatchType::Cylindrical:
+    return std::forward<Visitor>(visitor)(meta.cyl);
+  case PatchType::CubedSphereWedge:
+    return std::forward<Visitor>(visitor)(meta.cs_wedge);
+  default:
+    unreachable(); // never returns
+  }
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE inline Coord
+patch_l2g(const PatchType type, const MetaUnion &meta,
+          const Coord &l) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return cart_l2g(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return sph_l2g(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return cyl_l2g(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return cubedspherewedge_l2g(l, &m);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE inline Coord
+patch_g2l(const PatchType type, const MetaUnion &meta,
+          const Coord &g) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return cart_g2l(g, &m);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return sph_g2l(g, &m);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return cyl_g2l(g, &m);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return cubedspherewedge_g2l(g, &m);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE inline bool
+patch_is_valid(const PatchType type, const MetaUnion &meta,
+               const Coord &l) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return cart_valid(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return sph_valid(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return cyl_valid(l, &m);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return cubedspherewedge_valid(l, &m);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr Jac_t
+patch_jac_g2l_g(const PatchType type, const MetaUnion &meta,
+                const Coord &g) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return jac_cart2cart_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return jac_cart2sph_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return jac_cart2cyl_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return jac_cart2wedge_cart(g);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr Jac_t
+patch_jac_g2l_l(const PatchType type, const MetaUnion &meta,
+                const Coord &l) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return jac_cart2cart_cart(l);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return jac_cart2sph_sph(l);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return jac_cart2cyl_cyl(l);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return jac_cart2wedge_wedge(l);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr dJac_t
+patch_djac_g2l_g(const PatchType type, const MetaUnion &meta,
+                 const Coord &g) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return djac_cart2cart_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return djac_cart2sph_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return djac_cart2cyl_cart(g);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return djac_cart2wedge_cart(g);
+    }
+  });
+}
+
+[[nodiscard]] CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr dJac_t
+patch_djac_g2l_l(const PatchType type, const MetaUnion &meta,
+                 const Coord &l) noexcept {
+  return visit_meta(type, meta, [&](const auto &m) {
+    using MetaT = std::decay_t<decltype(m)>;
+    if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
+      return djac_cart2cart_cart(l);
+    } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
+      return djac_cart2sph_sph(l);
+    } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
+      return djac_cart2cyl_cyl(l);
+    } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
+      return djac_cart2wedge_wedge(l);
+    }
+  });
+}
+
 /**
  * @brief Represents a single computational grid in a larger multipatch system.
  *
@@ -102,138 +245,41 @@ struct Patch {
     }
   }
 
-private:
-  template <typename Visitor>
-  [[nodiscard]]
-  CCTK_HOST CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr decltype(auto)
-  visit_meta(Visitor &&visitor) const {
-    switch (type) {
-    case PatchType::Cartesian:
-      return std::forward<Visitor>(visitor)(meta.cart);
-    case PatchType::Spherical:
-      return std::forward<Visitor>(visitor)(meta.sph);
-    case PatchType::Cylindrical:
-      return std::forward<Visitor>(visitor)(meta.cyl);
-    case PatchType::CubedSphereWedge:
-      return std::forward<Visitor>(visitor)(meta.cs_wedge);
-    default:
-      unreachable(); // never returns
-    }
-  }
-
-public:
   [[nodiscard]] CCTK_HOST CCTK_DEVICE Coord l2g(const Coord &l) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return cart_l2g(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return sph_l2g(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return cyl_l2g(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return cubedspherewedge_l2g(l, &m);
-      }
-    });
+    return patch_l2g(type, meta, l);
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE Coord g2l(const Coord &g) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return cart_g2l(g, &m);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return sph_g2l(g, &m);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return cyl_g2l(g, &m);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return cubedspherewedge_g2l(g, &m);
-      }
-    });
+    return patch_g2l(type, meta, g);
   }
 
   [[nodiscard]] CCTK_HOST CCTK_DEVICE bool
   is_valid(const Coord &l) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return cart_valid(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return sph_valid(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return cyl_valid(l, &m);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return cubedspherewedge_valid(l, &m);
-      }
-    });
+    return patch_is_valid(type, meta, l);
   }
 
   [[nodiscard]] CCTK_HOST
       CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr Jac_t
       jac_g2l_g(const Coord &g) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return jac_cart2cart_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return jac_cart2sph_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return jac_cart2cyl_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return jac_cart2wedge_cart(g);
-      }
-    });
+    return patch_jac_g2l_g(type, meta, g);
   }
 
   [[nodiscard]] CCTK_HOST
       CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr Jac_t
       jac_g2l_l(const Coord &l) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return jac_cart2cart_cart(l);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return jac_cart2sph_sph(l);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return jac_cart2cyl_cyl(l);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return jac_cart2wedge_wedge(l);
-      }
-    });
+    return patch_jac_g2l_l(type, meta, l);
   }
 
   [[nodiscard]] CCTK_HOST
       CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr dJac_t
       djac_g2l_g(const Coord &g) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return djac_cart2cart_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return djac_cart2sph_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return djac_cart2cyl_cart(g);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return djac_cart2wedge_cart(g);
-      }
-    });
+    return patch_djac_g2l_g(type, meta, g);
   }
 
   [[nodiscard]] CCTK_HOST
       CCTK_DEVICE CCTK_ATTRIBUTE_ALWAYS_INLINE constexpr dJac_t
       djac_g2l_l(const Coord &l) const noexcept {
-    return visit_meta([&](const auto &m) {
-      using MetaT = std::decay_t<decltype(m)>;
-      if constexpr (std::is_same_v<MetaT, CartesianMeta>) {
-        return djac_cart2cart_cart(l);
-      } else if constexpr (std::is_same_v<MetaT, SphericalMeta>) {
-        return djac_cart2sph_sph(l);
-      } else if constexpr (std::is_same_v<MetaT, CylindricalMeta>) {
-        return djac_cart2cyl_cyl(l);
-      } else if constexpr (std::is_same_v<MetaT, CubedSphereWedgeMeta>) {
-        return djac_cart2wedge_wedge(l);
-      }
-    });
+    return patch_djac_g2l_l(type, meta, l);
   }
 };
 
@@ -75,24 +75,24 @@ cubedspherewedge_g2l(const Coord &g, const void *m) noexcept {
   //   eta = z / x;
   //   break;
   // case Wedge::NX:
-  //   xi = -y / x;
-  //   eta = z / x;
+  //   xi = y / x;
+  //   eta = -z / x;
   //   break;
   // case Wedge::PY:
   //   xi = -x / y;
   //   eta = z / y;
   //   break;
   // case Wedge::NY:
-  //   xi = x / y;
-  //   eta = z / y;
+  //   xi = -x / y;
+  //   eta = -z / y;
   //   break;
   // case Wedge::PZ:
   //   xi = x / z;
   //   eta = y / z;
   //   break;
   // case Wedge::NZ:
-  //   xi = x / z;
-  //   eta = -y / z;
+  //   xi = -x / z;
+  //   eta = y / z;
   //   break;
   // }
 
@@ -106,8 +106,8 @@ cubedspherewedge_g2l(const Coord &g, const void *m) noexcept {
   // All threads will execute the same division instructions, just with
   // different data.
   const CCTK_REAL denoms[] = {x, x, y, y, z, z};
-  const CCTK_REAL xi_nums[] = {y, -y, -x, x, x, x};
-  const CCTK_REAL eta_nums[] = {z, z, z, z, y, -y};
+  const CCTK_REAL xi_nums[] = {y, y, -x, -x, x, -x};
+  const CCTK_REAL eta_nums[] = {z, -z, z, -z, y, y};
 
   const CCTK_REAL xi = xi_nums[f] / denoms[f];
   const CCTK_REAL eta = eta_nums[f] / denoms[f];
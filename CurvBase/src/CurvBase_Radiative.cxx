@@ -0,0 +1,151 @@
+#include <cctk.h>
+
+#include <AMReX_Box.H>
+#include <AMReX_Gpu.H>
+
+#include "CurvBase_MultiPatch.hxx"
+#include "CurvBase_Radiative.hxx"
+
+#include <array>
+
+namespace CurvBase {
+using namespace Loop;
+
+CCTK_HOST RadialMap radial_map(const Patch &patch) {
+  switch (patch.type) {
+  case PatchType::Spherical:
+    return RadialMap{0, 0, 1};
+  case PatchType::CubedSphereWedge: {
+    // Rays from the origin have constant xi and eta
+    const CubedSphereWedgeMeta &m = patch.meta.cs_wedge;
+    return RadialMap{2, m.r_inner, m.r_outer - m.r_inner};
+  }
+  default:
+    return RadialMap{};
+  }
+}
+
+namespace {
+
+// The ghost zones of the radiative face are evolved, so the driver must not
+// apply a boundary condition to them
+CCTK_HOST void check_driver_boundary(const int d) {
+  static const std::array<bool, dim> upper_none = [] {
+    const std::array<const char *, dim> names{
+        "boundary_upper_x", "boundary_upper_y", "boundary_upper_z"};
+    std::array<bool, dim> none;
+    for (int dd = 0; dd < dim; ++dd) {
+      int type;
+      const void *const ptr = CCTK_ParameterGet(names[dd], "CarpetX", &type);
+      if (ptr == nullptr)
+        CCTK_VERROR("Parameter CarpetX::%s not found", names[dd]);
+      none[dd] = CCTK_EQUALS(*static_cast<const char *const *>(ptr), "none");
+    }
+    return none;
+  }();
+  if (!upper_none[d])
+    CCTK_VERROR("The radiative boundary in local direction %d requires "
+                "CarpetX::boundary_upper_%c = \"none\"",
+                d, "xyz"[d]);
+}
+
+} // namespace
+
+CCTK_HOST void apply_radiative(const cGH *cctkGH,
+                               const GridDescBaseDevice &grid,
+                               const GF3D2<const CCTK_REAL> &var,
+                               const GF3D2<CCTK_REAL> &rhs,
+                               const RadiativeCondition &cond) {
+  const Patch *const patch = multipatch().get_patch(grid.patch);
+  if (patch == nullptr)
+    CCTK_VERROR("Invalid patch %d", grid.patch);
+
+  const RadialMap radial = radial_map(*patch);
+  const int d = radial.dir;
+  const bool radiative = d >= 0 && patch->faces[1][d].is_outer_boundary &&
+                         patch->faces[1][d].symmetry == 0 &&
+                         cctkGH->cctk_bbox[2 * d + 1];
+
+  // Cell-centered extent of the box, ghost zones included
+  const int *const lsh = cctkGH->cctk_lsh;
+  const int *const ng = cctkGH->cctk_nghostzones;
+  const std::array<int, dim> np{lsh[0] - 1, lsh[1] - 1, lsh[2] - 1};
+
+  // This routine runs once per tile; each tile writes only its own cells
+  const amrex::Box tile(
+      amrex::IntVect(grid.tmin[0], grid.tmin[1], grid.tmin[2]),
+      amrex::IntVect(grid.tmax[0] - 1, grid.tmax[1] - 1, grid.tmax[2] - 1));
+
+  // Ghost cells of face f in direction dd that lie in the current tile
+  const auto ghost_box = [&](const int f, const int dd) {
+    std::array<int, dim> imin{0, 0, 0}, imax = np;
+    if (f == 0)
+      imax[dd] = ng[dd];
+    else
+      imin[dd] = np[dd] - ng[dd];
+    return amrex::Box(amrex::IntVect(imin[0], imin[1], imin[2]),
+                      amrex::IntVect(imax[0] - 1, imax[1] - 1, imax[2] - 1)) &
+           tile;
+  };
+
+  // All other outer faces of the box: symmetry or driver boundaries, which
+  // overwrite the state after each step
+  for (int f = 0; f < 2; ++f) {
+    for (int dd = 0; dd < dim; ++dd) {
+      if (!cctkGH->cctk_bbox[2 * dd + f] ||
+          !patch->faces[f][dd].is_outer_boundary)
+        continue;
+      if (radiative && f == 1 && dd == d)
+        continue;
+      const amrex::Box box = ghost_box(f, dd);
+      if (!box.ok())
+        continue;
+      amrex::ParallelFor(box, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+        rhs(vect<int, dim>{i, j, k}) = 0;
+      });
+    }
+  }
+
+  if (!radiative)
+    return;
+
+  check_driver_boundary(d);
+
+  if (np[d] - ng[d] < 2)
+    CCTK_VERROR("The box at the outer boundary in direction %d needs at least "
+                "2 cells",
+                d);
+
+  // Local coordinate of cell i in the radial direction
+  const CCTK_REAL dl = cctkGH->cctk_delta_space[d] / cctkGH->cctk_levfac[d];
+  const CCTK_REAL l0 =
+      cctkGH->cctk_origin_space[d] + (cctkGH->cctk_lbnd[d] + 0.5) * dl;
+  const CCTK_REAL inv_2dr = 1 / (2 * dl * radial.scale);
+
+  const CCTK_REAL value = cond.value;
+  const CCTK_REAL speed = cond.speed;
+  const CCTK_REAL falloff = cond.falloff;
+  const CCTK_REAL offset = radial.offset;
+  const CCTK_REAL scale = radial.scale;
+
+  const amrex::Box box = ghost_box(1, d);
+  if (!box.ok())
+    return;
+
+  // Ghost zones of the outer face, across the tile in the other directions;
+  // the stencil only reaches inwards along the radial lines, and may read
+  // the state of neighbouring tiles
+  amrex::ParallelFor(box, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+    const vect<int, dim> I{i, j, k};
+    vect<int, dim> I1 = I, I2 = I;
+    I1[d] -= 1;
+    I2[d] -= 2;
+
+    const CCTK_REAL r = offset + scale * (l0 + I[d] * dl);
+    const CCTK_REAL u = var(I);
+    const CCTK_REAL dr_u = (3 * u - 4 * var(I1) + var(I2)) * inv_2dr;
+    rhs(I) = -speed * (dr_u + falloff * (u - value) / r);
+  });
+}
+
+} // namespace CurvBase
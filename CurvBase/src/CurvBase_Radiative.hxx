@@ -0,0 +1,92 @@
+#ifndef CURVBASE_RADIATIVE_HXX
+#define CURVBASE_RADIATIVE_HXX
+
+/**
+ * @file
+ * @brief Radiative (Sommerfeld) boundary condition on the spherical outer
+ * faces of the multipatch system.
+ */
+
+#include <cctk.h>
+
+#include <array>
+#include <cstddef>
+
+#include "CurvBase.hxx"
+#include "CurvBase_Patch.hxx"
+
+namespace CurvBase {
+
+/**
+ * @brief Asymptotic behaviour of a grid function near the outer boundary,
+ * u = value + f(t - r / speed) / r^falloff.
+ *
+ * Tensors are stored in Cartesian components, each of which is an outgoing
+ * wave on its own: a tensor is handled one component at a time, with the
+ * asymptotic value of that component (e.g. 1 on the diagonal of the metric).
+ */
+struct RadiativeCondition {
+  CCTK_REAL value{0};
+  CCTK_REAL speed{1};
+  CCTK_REAL falloff{1};
+};
+
+/**
+ * @brief Radial coordinate lines of a patch.
+ *
+ * Along local direction `dir` the other local coordinates are constant and
+ * r = offset + scale * l[dir]. `dir` is -1 for patches without a radial
+ * direction.
+ */
+struct RadialMap {
+  int dir{-1};
+  CCTK_REAL offset{0}, scale{1};
+};
+
+[[nodiscard]] CCTK_HOST RadialMap radial_map(const Patch &patch);
+
+/**
+ * @brief Radiative boundary condition on the outer radial face, restricted
+ * to the current tile.
+ *
+ * Writes the RHS in the ghost zones of the upper face in the radial
+ * direction, if that face is an outer boundary of a `Spherical` or
+ * `CubedSphereWedge` patch:
+ *
+ *   d_t u = -speed (d_r u + falloff (u - value) / r),
+ *
+ * with a one-sided, second-order radial derivative along the radial
+ * coordinate lines. The ghost zones are evolved with the interior, so the
+ * driver must not apply a boundary condition on these faces: the upper
+ * boundary of CarpetX in the radial direction has to be "none", else this
+ * aborts.
+ *
+ * The RHS in the ghost zones of all other outer faces, symmetry faces
+ * included, is set to zero; their state is filled by the driver or by
+ * `apply_symmetries` after each step. The RHS is therefore written at every
+ * outer boundary point, and a routine calling this can declare
+ * `WRITES: rhs(boundary)`. Call in local mode after the interior RHS, with
+ * the state valid everywhere; each call writes only the cells of its tile.
+ * Only cell-centered grid functions are supported.
+ */
+CCTK_HOST void apply_radiative(const cGH *cctkGH,
+                               const Loop::GridDescBaseDevice &grid,
+                               const Loop::GF3D2<const CCTK_REAL> &var,
+                               const Loop::GF3D2<CCTK_REAL> &rhs,
+                               const RadiativeCondition &cond);
+
+/// Radiative boundary condition on all Cartesian components of a tensor,
+/// each with its own asymptotic behaviour
+template <std::size_t N>
+CCTK_HOST void
+apply_radiative(const cGH *cctkGH, const Loop::GridDescBaseDevice &grid,
+                const std::array<Loop::GF3D2<const CCTK_REAL>, N> &vars,
+                const std::array<Loop::GF3D2<CCTK_REAL>, N> &rhss,
+                const std::array<RadiativeCondition, N> &conds) {
+  for (std::size_t n = 0; n < N; ++n)
+    apply_radiative(cctkGH, grid, vars[n], rhss[n], conds[n]);
+}
+
+} // namespace CurvBase
+
+#endif // #ifndef CURVBASE_RADIATIVE_HXX
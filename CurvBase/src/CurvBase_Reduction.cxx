@@ -0,0 +1,156 @@
+#include <cctk.h>
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+
+#include "CurvBase_MultiPatch.hxx"
+#include "CurvBase_Reduction.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace CurvBase {
+using namespace Loop;
+
+namespace {
+
+// Number of grid functions reduced in one device pass
+constexpr std::size_t batch_size = 8;
+
+using Reduction = detail::VolumeReduce<std::make_index_sequence<batch_size>>;
+
+const CCTK_REAL *gf_data(const cGH *const cctkGH, const int vi) {
+  if (vi < 0 || CCTK_GroupTypeFromVarI(vi) != CCTK_GF)
+    CCTK_VERROR("Variable %d is not a grid function", vi);
+  const CCTK_REAL *const ptr =
+      static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, 0, vi));
+  if (ptr == nullptr)
+    CCTK_VERROR("Variable %d has no storage", vi);
+  return ptr;
+}
+
+} // namespace
+
+void VolumeReduction::begin(const std::size_t nvars) {
+  nvars_ = nvars;
+  volume_ = 0;
+  sum_.assign(nvars_, 0);
+  sum_abs_.assign(nvars_, 0);
+  sum2_.assign(nvars_, 0);
+  max_abs_.assign(nvars_, 0);
+  norms_.clear();
+}
+
+bool VolumeReduction::interior_box(const GridDescBaseDevice &grid,
+                                   amrex::Box &box) {
+  vect<int, dim> imin, imax;
+  grid.box_int<1, 1, 1>(grid.nghostzones, imin, imax);
+  if (any(imax <= imin))
+    return false;
+  box = amrex::Box(amrex::IntVect(imin[0], imin[1], imin[2]),
+                   amrex::IntVect(imax[0] - 1, imax[1] - 1, imax[2] - 1));
+  return true;
+}
+
+void VolumeReduction::weights(const cGH *const cctkGH,
+                              const GridDescBaseDevice &grid,
+                              const CCTK_REAL *&vol, const CCTK_REAL *&mask) {
+  // The Jacobians of the wedges are still zero, which makes their cell
+  // volumes infinite
+  const Patch *const patch = multipatch().get_patch(grid.patch);
+  if (patch != nullptr && patch->type == PatchType::CubedSphereWedge)
+    CCTK_VERROR("Cannot reduce over patch %d: the cell volumes of CubedSphere "
+                "wedges are not available, since their Jacobians are not "
+                "implemented",
+                grid.patch);
+  static const int vol_index = CCTK_VarIndex("CoordinatesX::cvol");
+  static const int mask_index = CCTK_VarIndex("CurvBase::cmask");
+  vol = gf_data(cctkGH, vol_index);
+  mask = gf_data(cctkGH, mask_index);
+}
+
+void VolumeReduction::add(const std::size_t first, const std::size_t count,
+                          const CCTK_REAL volume, const CCTK_REAL *const sum,
+                          const CCTK_REAL *const sum_abs,
+                          const CCTK_REAL *const sum2,
+                          const CCTK_REAL *const max_abs) {
+#pragma omp critical(CurvBase_VolumeReduction)
+  {
+    if (first == 0)
+      volume_ += volume;
+    for (std::size_t b = 0; b < count; ++b) {
+      sum_[first + b] += sum[b];
+      sum_abs_[first + b] += sum_abs[b];
+      sum2_[first + b] += sum2[b];
+      max_abs_[first + b] = std::max(max_abs_[first + b], max_abs[b]);
+    }
+  }
+}
+
+void VolumeReduction::reduce(const cGH *const cctkGH,
+                             const GridDescBaseDevice &grid,
+                             const std::vector<int> &varindices) {
+  if (varindices.size() != nvars_)
+    CCTK_VERROR("Reduction was begun for %zu variables, but %zu were given",
+                nvars_, varindices.size());
+
+  amrex::Box box;
+  if (!interior_box(grid, box))
+    return;
+  const CCTK_REAL *vol, *mask;
+  weights(cctkGH, grid, vol, mask);
+  const GF3D2layout layout(cctkGH, {1, 1, 1});
+
+  // The volume is the same in every batch; a last, partial batch repeats its
+  // first grid function and ignores the extra results
+  for (std::size_t first = 0; first < std::max(nvars_, std::size_t{1});
+       first += batch_size) {
+    const std::size_t count = std::min(batch_size, nvars_ - first);
+    const CCTK_REAL *const padding =
+        (count > 0) ? gf_data(cctkGH, varindices[first]) : vol;
+    std::array<const CCTK_REAL *, batch_size> gfs;
+    for (std::size_t b = 0; b < batch_size; ++b)
+      gfs[b] = (b < count) ? gf_data(cctkGH, varindices[first + b]) : padding;
+    const VolumeSums<batch_size> sums = Reduction::eval(
+        box, layout, vol, mask,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+          const int ijk = layout.linear(i, j, k);
+          std::array<CCTK_REAL, batch_size> f;
+          for (std::size_t b = 0; b < batch_size; ++b)
+            f[b] = gfs[b][ijk];
+          return f;
+        });
+    add(first, count, sums.volume, sums.sum.data(), sums.sum_abs.data(),
+        sums.sum2.data(), sums.max_abs.data());
+  }
+}
+
+void VolumeReduction::finish() {
+  std::vector<CCTK_REAL> sums;
+  sums.reserve(1 + 3 * nvars_);
+  sums.push_back(volume_);
+  sums.insert(sums.end(), sum_.begin(), sum_.end());
+  sums.insert(sums.end(), sum_abs_.begin(), sum_abs_.end());
+  sums.insert(sums.end(), sum2_.begin(), sum2_.end());
+  amrex::ParallelDescriptor::ReduceRealSum(sums.data(),
+                                           static_cast<int>(sums.size()));
+  std::vector<CCTK_REAL> max_abs = max_abs_;
+  amrex::ParallelDescriptor::ReduceRealMax(max_abs.data(),
+                                           static_cast<int>(max_abs.size()));
+
+  const CCTK_REAL volume = sums[0];
+  norms_.resize(nvars_);
+  for (std::size_t v = 0; v < nvars_; ++v) {
+    VolumeNorms &n = norms_[v];
+    n.volume = volume;
+    n.integral = sums[1 + v];
+    n.l1 = volume > 0 ? sums[1 + nvars_ + v] / volume : CCTK_REAL{0};
+    n.l2 = volume > 0 ? std::sqrt(sums[1 + 2 * nvars_ + v] / volume)
+                      : CCTK_REAL{0};
+    n.max = max_abs[v];
+  }
+}
+
+} // namespace CurvBase
@@ -0,0 +1,186 @@
+#ifndef CURVBASE_REDUCTION_HXX
+#define CURVBASE_REDUCTION_HXX
+
+/**
+ * @file
+ * @brief Volume-weighted norms and integrals of grid functions on multipatch
+ * grids.
+ */
+
+#include <cctk.h>
+
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "CurvBase.hxx"
+
+namespace CurvBase {
+
+/// Volume-weighted norms of one grid function
+struct VolumeNorms {
+  CCTK_REAL volume{0};   ///< volume of the domain
+  CCTK_REAL integral{0}; ///< integral of f
+  CCTK_REAL l1{0};       ///< volume average of |f|
+  CCTK_REAL l2{0};       ///< root mean square of f
+  CCTK_REAL max{0};      ///< maximum of |f|
+};
+
+/// Volume and weighted sums of `N` functions over the cells of one box
+template <std::size_t N> struct VolumeSums {
+  CCTK_REAL volume;
+  std::array<CCTK_REAL, N> sum, sum_abs, sum2, max_abs;
+};
+
+namespace detail {
+
+// Reduce the volume and sum(w f), sum(w |f|), sum(w f^2) and max|f| of all
+// components of f(i, j, k) in a single device pass
+template <typename Seq> struct VolumeReduce;
+
+template <std::size_t... Is> struct VolumeReduce<std::index_sequence<Is...>> {
+  template <std::size_t> using Max = amrex::ReduceOpMax;
+  template <std::size_t> using Sum = amrex::ReduceOpSum;
+  template <std::size_t> using Real = CCTK_REAL;
+  static constexpr std::size_t n = sizeof...(Is);
+
+  using Ops = amrex::ReduceOps<amrex::ReduceOpSum, Sum<Is>..., Sum<Is>...,
+                               Sum<Is>..., Max<Is>...>;
+  using Data = amrex::ReduceData<CCTK_REAL, Real<Is>..., Real<Is>...,
+                                 Real<Is>..., Real<Is>...>;
+
+  template <typename F>
+  static VolumeSums<n> eval(const amrex::Box &box,
+                            const Loop::GF3D2layout &layout,
+                            const CCTK_REAL *const vol,
+                            const CCTK_REAL *const mask, const F &f) {
+    Ops ops;
+    Data data(ops);
+    ops.eval(box, data, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+      const int ijk = layout.linear(i, j, k);
+      const CCTK_REAL w = vol[ijk] * mask[ijk];
+      const std::array<CCTK_REAL, n> fijk = f(i, j, k);
+      return amrex::makeTuple(w, (w * fijk[Is])...,
+                              (w * std::fabs(fijk[Is]))...,
+                              (w * fijk[Is] * fijk[Is])...,
+                              std::fabs(fijk[Is])...);
+    });
+    const auto res = data.value(ops);
+    return {amrex::get<0>(res),
+            {amrex::get<1 + Is>(res)...},
+            {amrex::get<1 + n + Is>(res)...},
+            {amrex::get<1 + 2 * n + Is>(res)...},
+            {amrex::get<1 + 3 * n + Is>(res)...}};
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Fused reduction of several cell-centered grid functions.
+ *
+ * Each cell is weighted by its physical volume `CoordinatesX::cvol`, times
+ * `CurvBase::cmask` so that cells in overlapping patches are only counted
+ * once. All norms of up to 8 grid functions are reduced in a single device
+ * pass per box; more grid functions take one pass per 8.
+ *
+ * A reduction is done in three steps, as for `SphereExtraction`:
+ * 1. `begin` (global mode) clears the sums for `nvars` grid functions,
+ * 2. `reduce` (local mode) adds the interior cells of the current box,
+ * 3. `finish` (global mode) combines all processes and computes the norms.
+ *
+ * Instead of grid functions, `reduce` also accepts a pointwise integrand,
+ * which is evaluated inside the reduction kernel, so that quantities such as
+ * energy densities need no grid function of their own.
+ *
+ * Routines calling `reduce` need to read `CoordinatesX::cell_volume` and
+ * `CurvBase::cell_mask` in the interior. With a reflection symmetry, only
+ * the fundamental domain is summed: the L1, L2 and max norms are those of the
+ * full domain, while volumes and integrals of even functions need a factor 2
+ * per symmetry plane.
+ *
+ * There is no refinement mask: every box passed to `reduce` is summed, so
+ * with mesh refinement a region covered by several levels is counted once
+ * per level. Call `reduce` only for the boxes of a single level in that case.
+ *
+ * The cell volumes need the Jacobians of the patches. CubedSphere wedges do
+ * not have them yet, so reducing a box of a wedge is an error.
+ */
+class VolumeReduction {
+  std::size_t nvars_{0};
+  CCTK_REAL volume_{0};
+  std::vector<CCTK_REAL> sum_, sum_abs_, sum2_, max_abs_;
+  std::vector<VolumeNorms> norms_;
+
+public:
+  /// Clear the sums for `nvars` grid functions
+  CCTK_HOST void begin(std::size_t nvars);
+
+  /// Add the interior cells of the current box. Call in local mode, once per
+  /// box.
+  CCTK_HOST void reduce(const cGH *cctkGH, const Loop::GridDescBaseDevice &grid,
+                        const std::vector<int> &varindices);
+
+  /**
+   * @brief Add the integrand at the interior cells of the current box.
+   *
+   * `f(i, j, k)` is called on the device with the cell indices of the box,
+   * as used by `GF3D2` and `GF3D2layout`, and returns the `N` values of the
+   * integrand, where `N` is the number of functions given to `begin`. Call
+   * in local mode, once per box.
+   */
+  template <std::size_t N, typename F>
+  CCTK_HOST void reduce(const cGH *cctkGH, const Loop::GridDescBaseDevice &grid,
+                        const F &f) {
+    if (N != nvars_)
+      CCTK_VERROR("Reduction was begun for %zu functions, but %zu were given",
+                  nvars_, N);
+    amrex::Box box;
+    if (!interior_box(grid, box))
+      return;
+    const CCTK_REAL *vol, *mask;
+    weights(cctkGH, grid, vol, mask);
+    const Loop::GF3D2layout layout(cctkGH, {1, 1, 1});
+    const VolumeSums<N> sums =
+        detail::VolumeReduce<std::make_index_sequence<N>>::eval(
+            box, layout, vol, mask, f);
+    add(0, N, sums.volume, sums.sum.data(), sums.sum_abs.data(),
+        sums.sum2.data(), sums.max_abs.data());
+  }
+
+  /// Sum the contributions of all boxes and processes
+  CCTK_HOST void finish();
+
+  [[nodiscard]] CCTK_HOST std::size_t num_vars() const noexcept {
+    return nvars_;
+  }
+
+  [[nodiscard]] CCTK_HOST const VolumeNorms &norms(std::size_t var) const {
+    return norms_.at(var);
+  }
+
+private:
+  // Interior cells of the box; false if there are none
+  CCTK_HOST static bool interior_box(const Loop::GridDescBaseDevice &grid,
+                                     amrex::Box &box);
+
+  // Cell volumes and overlap mask of the current box
+  CCTK_HOST static void weights(const cGH *cctkGH,
+                                const Loop::GridDescBaseDevice &grid,
+                                const CCTK_REAL *&vol, const CCTK_REAL *&mask);
+
+  // Accumulate the sums of functions [first, first + count) of one box; the
+  // volume is only counted with the first function
+  CCTK_HOST void add(std::size_t first, std::size_t count, CCTK_REAL volume,
+                     const CCTK_REAL *sum, const CCTK_REAL *sum_abs,
+                     const CCTK_REAL *sum2, const CCTK_REAL *max_abs);
+};
+
+} // namespace CurvBase
+
+#endif // #ifndef CURVBASE_REDUCTION_HXX
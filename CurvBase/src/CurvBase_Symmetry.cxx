@@ -0,0 +1,97 @@
+#include <cctk.h>
+
+#include <AMReX_Box.H>
+#include <AMReX_Gpu.H>
+
+#include "CurvBase_MultiPatch.hxx"
+#include "CurvBase_Symmetry.hxx"
+
+#include <array>
+
+namespace CurvBase {
+using namespace Loop;
+
+CCTK_HOST void apply_symmetries(const cGH *cctkGH,
+                                const GridDescBaseDevice &grid,
+                                const GF3D2<CCTK_REAL> &gf,
+                                const Parity &parity,
+                                const bool before_sync) {
+  const Patch *const patch = multipatch().get_patch(grid.patch);
+  if (patch == nullptr)
+    CCTK_VERROR("Invalid patch %d", grid.patch);
+
+  // Cell-centered extent of the box, ghost zones included
+  const int *const lsh = cctkGH->cctk_lsh;
+  const int *const ng = cctkGH->cctk_nghostzones;
+  const std::array<int, dim> np{lsh[0] - 1, lsh[1] - 1, lsh[2] - 1};
+
+  // Cells of the current tile; the tiles at the faces of the box include
+  // the ghost zones there
+  const amrex::Box tile(
+      amrex::IntVect(grid.tmin[0], grid.tmin[1], grid.tmin[2]),
+      amrex::IntVect(grid.tmax[0] - 1, grid.tmax[1] - 1, grid.tmax[2] - 1));
+
+  for (int d = 0; d < dim; ++d) {
+    for (int f = 0; f < 2; ++f) {
+      const int planes = patch->faces[f][d].symmetry;
+      if (planes == 0 || !cctkGH->cctk_bbox[2 * d + f])
+        continue;
+
+      if (np[d] - 2 * ng[d] < ng[d])
+        CCTK_VERROR("The box at the symmetry face in direction %d needs at "
+                    "least %d interior cells",
+                    d, ng[d]);
+
+      CCTK_REAL sign = 1;
+      for (int a = 0; a < dim; ++a)
+        if (planes & (1 << a))
+          sign *= parity[a];
+
+      // Ghost zones of this face, across the whole box in the other
+      // directions (only across the interior before the SYNC); a ghost cell
+      // i is the mirror image of cell (mirror - i)
+      std::array<int, dim> imin{0, 0, 0}, imax = np;
+      if (before_sync) {
+        for (int a = 0; a < dim; ++a) {
+          imin[a] = ng[a];
+          imax[a] = np[a] - ng[a];
+        }
+      }
+      int mirror;
+      if (f == 0) {
+        imin[d] = 0;
+        imax[d] = ng[d];
+        mirror = 2 * ng[d] - 1;
+      } else {
+        imin[d] = np[d] - ng[d];
+        imax[d] = np[d];
+        mirror = 2 * (np[d] - ng[d]) - 1;
+      }
+
+      const amrex::Box box =
+          amrex::Box(amrex::IntVect(imin[0], imin[1], imin[2]),
+                     amrex::IntVect(imax[0] - 1, imax[1] - 1, imax[2] - 1)) &
+          tile;
+      if (!box.ok())
+        continue;
+
+      // The mirror images must lie in the same tile: an edge or corner
+      // reads ghost cells that this tile filled for an earlier direction,
+      // and another tile might still be filling its own
+      const int jmin = mirror - box.bigEnd(d), jmax = mirror - box.smallEnd(d);
+      if (jmin < tile.smallEnd(d) || jmax > tile.bigEnd(d))
+        CCTK_VERROR("The tile at the symmetry face in direction %d needs at "
+                    "least %d interior cells",
+                    d, ng[d]);
+
+      amrex::ParallelFor(box, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+        const vect<int, dim> I{i, j, k};
+        vect<int, dim> J = I;
+        J[d] = mirror - I[d];
+        gf(I) = sign * gf(J);
+      });
+    }
+  }
+}
+
+} // namespace CurvBase
@@ -0,0 +1,68 @@
+#ifndef CURVBASE_SYMMETRY_HXX
+#define CURVBASE_SYMMETRY_HXX
+
+/**
+ * @file
+ * @brief Ghost zone filling across the reflection symmetry faces of the
+ * multipatch system.
+ */
+
+#include <cctk.h>
+
+#include <array>
+
+#include "CurvBase.hxx"
+
+namespace CurvBase {
+
+/**
+ * @brief Sign of a grid function under a reflection in x, y and z.
+ *
+ * Tensors are stored in Cartesian components, so the parity of a component
+ * does not depend on the patch: each index equal to the reflected axis
+ * contributes a factor -1.
+ */
+using Parity = std::array<int, dim>;
+
+constexpr Parity scalar_parity{+1, +1, +1};
+
+/// Parity of component `a` of a vector or covector
+constexpr Parity vector_parity(int a) {
+  Parity p = scalar_parity;
+  p[a] = -p[a];
+  return p;
+}
+
+/// Parity of component `ab` of a rank-2 tensor
+constexpr Parity tensor_parity(int a, int b) {
+  Parity p = vector_parity(a);
+  p[b] = -p[b];
+  return p;
+}
+
+/**
+ * @brief Fill the ghost zones of the current tile across symmetry faces.
+ *
+ * Each ghost cell takes the value of its mirror image in the interior, times
+ * the parity of the reflection of the face. Call in local mode after the
+ * grid function has been synchronized; only the cells of the current tile
+ * are written. Faces are handled one direction after the other, so that
+ * edges and corners are filled as well; the tiles at a symmetry face must
+ * therefore hold at least as many interior cells as there are ghost zones.
+ * Only cell-centered grid functions are supported.
+ *
+ * The interpatch interpolation of a SYNC may read the symmetry ghost zones
+ * of its source patches, so call this also before the SYNC, with
+ * `before_sync` set. Only the ghost cells next to the interior of the box
+ * are then filled, since they depend on interior cells alone; edges and
+ * corners wait for the call after the SYNC.
+ */
+CCTK_HOST void apply_symmetries(const cGH *cctkGH,
+                                const Loop::GridDescBaseDevice &grid,
+                                const Loop::GF3D2<CCTK_REAL> &gf,
+                                const Parity &parity,
+                                bool before_sync = false);
+
+} // namespace CurvBase
+
+#endif // #ifndef CURVBASE_SYMMETRY_HXX
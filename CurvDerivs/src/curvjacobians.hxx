@@ -0,0 +1,39 @@
+#ifndef CURVDERIVS_CURVJACOBIANS_HXX
+#define CURVDERIVS_CURVJACOBIANS_HXX
+
+#include <cctk.h>
+
+#include <array>
+
+namespace CurvDerivs {
+using namespace std;
+
+// Cell-centered Jacobians of CurvBase on the current box, in the order
+// expected by calc_trans and calc_transderivs
+struct JacobianPtrs {
+  array<const CCTK_REAL *, 9> Jac;
+  array<const CCTK_REAL *, 18> dJac;
+};
+
+inline JacobianPtrs jacobian_ptrs(const cGH *cctkGH) {
+  // The variables of a group have consecutive indices in the order in which
+  // they are declared
+  static const int Jac0 = CCTK_FirstVarIndex("CurvBase::cell_Jacobians");
+  static const int dJac0 = CCTK_FirstVarIndex("CurvBase::cell_dJacobians");
+  if (Jac0 < 0 || dJac0 < 0)
+    CCTK_ERROR("CurvBase Jacobians are not available");
+
+  const auto ptr = [&](const int vi) {
+    return static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, 0, vi));
+  };
+  JacobianPtrs ptrs;
+  for (int n = 0; n < 9; ++n)
+    ptrs.Jac[n] = ptr(Jac0 + n);
+  for (int n = 0; n < 18; ++n)
+    ptrs.dJac[n] = ptr(dJac0 + n);
+  return ptrs;
+}
+
+} // namespace CurvDerivs
+
+#endif // #ifndef CURVDERIVS_CURVJACOBIANS_HXX
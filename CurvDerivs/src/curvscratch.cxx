@@ -0,0 +1,126 @@
+#include "curvscratch.hxx"
+
+#include <AMReX_Arena.H>
+#include <AMReX_Gpu.H>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace CurvDerivs {
+
+namespace {
+
+// A tile of a box. CarpetX hands the tiles of a box to different OpenMP
+// threads, so each tile needs its own temporaries.
+struct ScratchKey {
+  int patch, level;
+  array<int, dim> lbnd, lsh, tmin;
+
+  bool operator<(const ScratchKey &other) const {
+    return tie(patch, level, lbnd, lsh, tmin) <
+           tie(other.patch, other.level, other.lbnd, other.lsh, other.tmin);
+  }
+};
+
+struct ScratchEntry {
+  int generation{0};
+  void *ptr{nullptr};
+  size_t bytes{0};
+};
+
+map<ScratchKey, ScratchEntry> g_scratch;
+
+// Buffers that were replaced by larger ones. Kernels of earlier calls may
+// still use them, so they are only freed once the device is idle.
+vector<void *> g_retired;
+
+// Incremented before each regrid. Entries that were not touched since belong
+// to boxes that no longer exist.
+int g_scratch_generation = 0;
+
+ScratchKey make_key(const GridDescBaseDevice &grid, const int level) {
+  ScratchKey key{grid.patch, level, {}, {}, {}};
+  for (int d = 0; d < dim; ++d) {
+    key.lbnd[d] = grid.lbnd[d];
+    key.lsh[d] = grid.lsh[d];
+    key.tmin[d] = grid.tmin[d];
+  }
+  return key;
+}
+
+void free_retired() {
+  for (void *const ptr : g_retired)
+    amrex::The_Arena()->free(ptr);
+  g_retired.clear();
+}
+
+} // namespace
+
+void *scratch_buffer(const GridDescBaseDevice &grid, const int level,
+                     const size_t bytes) {
+  const ScratchKey key = make_key(grid, level);
+
+  void *ptr;
+#pragma omp critical(CurvDerivs_Scratch)
+  {
+    ScratchEntry &entry = g_scratch[key];
+    entry.generation = g_scratch_generation;
+    if (entry.bytes < bytes) {
+      if (entry.ptr != nullptr)
+        g_retired.push_back(entry.ptr);
+      entry.ptr = amrex::The_Arena()->alloc(bytes);
+      entry.bytes = bytes;
+    }
+    ptr = entry.ptr;
+  }
+  return ptr;
+}
+
+extern "C" void CurvDerivs_Scratch_BeginRegrid(CCTK_ARGUMENTS) {
+  ++g_scratch_generation;
+}
+
+extern "C" void CurvDerivs_Scratch_Mark(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_CurvDerivs_Scratch_Mark;
+
+  // Keep all tiles of this box, however the driver tiles it now
+  ScratchKey first = make_key(grid, ilogb(cctkGH->cctk_levfac[0]));
+  first.tmin.fill(numeric_limits<int>::min());
+#pragma omp critical(CurvDerivs_Scratch)
+  for (auto it = g_scratch.lower_bound(first);
+       it != g_scratch.end() && it->first.patch == first.patch &&
+       it->first.level == first.level && it->first.lbnd == first.lbnd &&
+       it->first.lsh == first.lsh;
+       ++it)
+    it->second.generation = g_scratch_generation;
+}
+
+extern "C" void CurvDerivs_Scratch_Prune(CCTK_ARGUMENTS) {
+  amrex::Gpu::streamSynchronizeAll();
+  for (auto it = g_scratch.begin(); it != g_scratch.end();) {
+    if (it->second.generation != g_scratch_generation) {
+      amrex::The_Arena()->free(it->second.ptr);
+      it = g_scratch.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  free_retired();
+}
+
+extern "C" void CurvDerivs_Scratch_Free(CCTK_ARGUMENTS) {
+  amrex::Gpu::streamSynchronizeAll();
+  for (auto &[key, entry] : g_scratch)
+    amrex::The_Arena()->free(entry.ptr);
+  g_scratch.clear();
+  free_retired();
+}
+
+} // namespace CurvDerivs
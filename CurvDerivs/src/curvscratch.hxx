@@ -0,0 +1,66 @@
+#ifndef CURVDERIVS_CURVSCRATCH_HXX
+#define CURVDERIVS_CURVSCRATCH_HXX
+
+#include <loop_device.hxx>
+
+#include <cctk.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace CurvDerivs {
+using namespace Loop;
+using namespace std;
+
+// Persistent buffer of at least `bytes` bytes for the temporaries of a tile
+// on refinement level `level`. Each tile (patch, level, index extent of the
+// box and tile origin) owns its buffer, so threads and streams working on
+// different tiles never share memory. The buffer is allocated on first use
+// and only grows; a buffer that is outgrown stays allocated until the next
+// regrid, since earlier kernels may still use it. A regrid releases the
+// buffers of the boxes that it removes.
+void *scratch_buffer(const GridDescBaseDevice &grid, int level, size_t bytes);
+
+// Hands out GF3D5 temporaries from the scratch buffer of the current box.
+// Drop-in replacement for CXUtils::GF3D5Factory that does not allocate once
+// the buffer of the box exists.
+template <typename T> class Scratch {
+  GF3D5layout layout_;
+  T *data_;
+  int ntmps_;
+  int itmp_{0};
+
+public:
+  Scratch(const GridDescBaseDevice &grid, const int level,
+          const GF3D5layout &layout, const int ntmps)
+      : layout_(layout),
+        data_(static_cast<T *>(scratch_buffer(
+            grid, level, sizeof(T) * size_t(layout.np) * size_t(ntmps)))),
+        ntmps_(ntmps) {}
+
+  Scratch(const cGH *cctkGH, const GridDescBaseDevice &grid,
+          const GF3D5layout &layout, const int ntmps)
+      : Scratch(grid, ilogb(cctkGH->cctk_levfac[0]), layout, ntmps) {}
+
+  // Number of temporaries handed out so far
+  int count() const { return itmp_; }
+
+  GF3D5<T> make_gf() {
+    if (itmp_ >= ntmps_)
+      CCTK_VERROR("Too many temporary variables: ntmps=%d", ntmps_);
+    return GF3D5<T>(layout_, data_ + size_t(itmp_++) * size_t(layout_.np));
+  }
+
+  array<GF3D5<T>, 3> make_vec_gf() {
+    return {make_gf(), make_gf(), make_gf()};
+  }
+
+  array<GF3D5<T>, 6> make_smat_gf() {
+    return {make_gf(), make_gf(), make_gf(), make_gf(), make_gf(), make_gf()};
+  }
+};
+
+} // namespace CurvDerivs
+
+#endif // #ifndef CURVDERIVS_CURVSCRATCH_HXX
@@ -0,0 +1,129 @@
+#ifndef CURVDERIVS_CURVTASKS_HXX
+#define CURVDERIVS_CURVTASKS_HXX
+
+#include <cx_utils.hxx>
+#include <loop_device.hxx>
+
+#include <AMReX_Gpu.H>
+
+#include <cctk.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace CurvDerivs {
+using namespace Loop;
+using namespace std;
+
+// What the derivative and RHS kernels need to know about a box. It does not
+// refer to the cGH, so that a box can also be evaluated as a task after the
+// driver has moved on to the next box.
+struct BoxDesc {
+  GridDescBaseDevice grid;
+  GF3D2layout layout2;
+  GF3D5layout layout5;
+  array<CCTK_REAL, 3> invDxyz;
+  int level;
+
+  explicit BoxDesc(const cGH *restrict const cctkGH)
+      : grid(cctkGH), layout2(cctkGH, {1, 1, 1}),
+        layout5(CXUtils::get_GF3D5layout<1, 1, 1>(cctkGH)),
+        level(ilogb(cctkGH->cctk_levfac[0])) {
+    for (int d = 0; d < 3; ++d)
+      invDxyz[d] = cctkGH->cctk_levfac[d] / cctkGH->cctk_delta_space[d];
+  }
+};
+
+// Runs jobs concurrently: as OpenMP tasks on the host, or on the device
+// streams. A job may depend on one earlier job, e.g. the RHS of a box on the
+// derivatives of that box; it then starts only after that job has finished.
+// The driver visits the boxes one patch after the other; collecting the
+// boxes of all patches first and running them as one group keeps all cores
+// or streams busy even when every single patch is too small to do so.
+//
+// Jobs are plain function pointers with an argument that the caller keeps
+// alive until `run` returns, so that adding jobs does not allocate once the
+// group has reached its size. Keep the group across calls.
+class TaskGroup {
+public:
+  using Function = void (*)(const void *arg);
+
+private:
+  struct Job {
+    Function fn;
+    const void *arg;
+    int after;
+    int stream;
+  };
+  vector<Job> jobs_;
+  vector<char> deps_;
+  int next_stream_{0};
+
+public:
+  void reserve(const size_t njobs) {
+    jobs_.reserve(njobs);
+    deps_.reserve(njobs);
+  }
+
+  size_t size() const { return jobs_.size(); }
+
+  // Add job `fn(arg)`, which starts after job `after` (-1: at once). Returns
+  // the job number.
+  int add(const Function fn, const void *const arg, const int after = -1) {
+    if (after >= int(jobs_.size()))
+      CCTK_VERROR("Job %d depends on the later job %d", int(jobs_.size()),
+                  after);
+    int stream = 0;
+#ifdef AMREX_USE_GPU
+    // A job runs on the stream of the job it depends on, which orders them
+    stream = after >= 0 ? jobs_[after].stream
+                        : next_stream_++ % amrex::Gpu::numGpuStreams();
+#endif
+    jobs_.push_back({fn, arg, after, stream});
+    return int(jobs_.size()) - 1;
+  }
+
+  // Add job `F(arg)`
+  template <typename T, void (*F)(const T &)>
+  int add(const T &arg, const int after = -1) {
+    return add([](const void *const p) { F(*static_cast<const T *>(p)); },
+               &arg, after);
+  }
+
+  // Run all jobs and wait for them to finish
+  void run() {
+#ifdef AMREX_USE_GPU
+    for (const Job &job : jobs_) {
+      amrex::Gpu::Device::setStreamIndex(job.stream);
+      job.fn(job.arg);
+    }
+    amrex::Gpu::Device::resetStreamIndex();
+    amrex::Gpu::synchronize();
+#else
+    deps_.resize(jobs_.size());
+    const Job *const jobs = jobs_.data();
+    char *const deps = deps_.data();
+    const int njobs = int(jobs_.size());
+#pragma omp parallel
+#pragma omp single
+    for (int n = 0; n < njobs; ++n) {
+      if (jobs[n].after < 0) {
+#pragma omp task firstprivate(n) depend(out : deps[n])
+        jobs[n].fn(jobs[n].arg);
+      } else {
+#pragma omp task firstprivate(n) depend(in : deps[jobs[n].after])            \
+    depend(out : deps[n])
+        jobs[n].fn(jobs[n].arg);
+      }
+    }
+#endif
+    jobs_.clear();
+    next_stream_ = 0;
+  }
+};
+
+} // namespace CurvDerivs
+
+#endif // #ifndef CURVDERIVS_CURVTASKS_HXX
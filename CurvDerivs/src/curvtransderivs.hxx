@@ -37,7 +37,8 @@ calc_transderivs(const GridDescBaseDevice &grid, const GF3D5layout &layout5,
                  const array<const T *, 18> &gf_dJac) {
   for (int a = 0; a < 3; ++a)
     calc_transderivs<CI, CJ, CK, DORDER>(grid, layout5, tl_duO[a], tl_dduO[a],
-                                         layout2, uI, invDxyz, gf_Jac, gf_dJac);
+                                         layout2, uI[a], invDxyz, gf_Jac,
+                                         gf_dJac);
 }
 
 template <int CI, int CJ, int CK, int DORDER, typename T>
@@ -50,7 +51,8 @@ calc_transderivs(const GridDescBaseDevice &grid, const GF3D5layout &layout5,
                  const array<const T *, 18> &gf_dJac) {
   for (int a = 0; a < 6; ++a)
     calc_transderivs<CI, CJ, CK, DORDER>(grid, layout5, tl_duO[a], tl_dduO[a],
-                                         layout2, uI, invDxyz, gf_Jac, gf_dJac);
+                                         layout2, uI[a], invDxyz, gf_Jac,
+                                         gf_dJac);
 }
 
 } // namespace CurvDerivs
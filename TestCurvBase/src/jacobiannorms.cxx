@@ -0,0 +1,181 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_MultiPatch.hxx>
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+constexpr int ncomps = 9 + 18;
+
+const array<const char *, ncomps> comp_names{
+    "cJ1x",   "cJ1y",   "cJ1z",   "cJ2x",   "cJ2y",   "cJ2z",   "cJ3x",
+    "cJ3y",   "cJ3z",   "cdJ1xx", "cdJ1xy", "cdJ1xz", "cdJ1yy", "cdJ1yz",
+    "cdJ1zz", "cdJ2xx", "cdJ2xy", "cdJ2xz", "cdJ2yy", "cdJ2yz", "cdJ2zz",
+    "cdJ3xx", "cdJ3xy", "cdJ3xz", "cdJ3yy", "cdJ3yz", "cdJ3zz"};
+
+// Errors of all Jacobian and Jacobian derivative components at one point
+using Errors = array<CCTK_REAL, ncomps>;
+
+// Reduce max|e| and sum(e^2) of all components in a single device pass
+template <typename Seq> struct NormReduction;
+
+template <size_t... Is> struct NormReduction<index_sequence<Is...>> {
+  template <size_t> using Max = amrex::ReduceOpMax;
+  template <size_t> using Sum = amrex::ReduceOpSum;
+  template <size_t> using Real = CCTK_REAL;
+
+  using Ops = amrex::ReduceOps<Max<Is>..., Sum<Is>...>;
+  using Data = amrex::ReduceData<Real<Is>..., Real<Is>...>;
+
+  template <typename F>
+  static pair<Errors, Errors> eval(const amrex::Box &box, const F &calc_errors) {
+    Ops ops;
+    Data data(ops);
+    ops.eval(box, data, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+      const Errors e = calc_errors(i, j, k);
+      return amrex::makeTuple(std::fabs(e[Is])..., (e[Is] * e[Is])...);
+    });
+    const auto res = data.value(ops);
+    return {Errors{amrex::get<Is>(res)...},
+            Errors{amrex::get<ncomps + Is>(res)...}};
+  }
+};
+
+using ErrorNorms = NormReduction<make_index_sequence<ncomps>>;
+
+struct PatchNorms {
+  Errors max_err{};
+  Errors sum2_err{};
+  CCTK_REAL npoints{0};
+};
+
+// Norms accumulated over all boxes of this process, indexed by patch
+vector<PatchNorms> patch_norms;
+
+extern "C" void TestCurvBase_ResetJacobianNorms(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_ResetJacobianNorms;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_EQUALS(patch_system, "none"))
+    CCTK_ERROR("No multi-patch system");
+
+  patch_norms.assign(active_mp().size(), PatchNorms{});
+}
+
+extern "C" void TestCurvBase_ReduceJacobianErrors(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_ReduceJacobianErrors;
+  DECLARE_CCTK_PARAMETERS;
+
+  auto mp = active_mp();
+  const int patch = grid.patch;
+
+  // Ghost zones are excluded: across the coordinate axes their global
+  // coordinates map back to a different local point
+  vect<int, dim> imin, imax;
+  grid.box_int<1, 1, 1>(grid.nghostzones, imin, imax);
+  if (any(imax <= imin))
+    return;
+  const amrex::Box box(amrex::IntVect(imin[0], imin[1], imin[2]),
+                       amrex::IntVect(imax[0] - 1, imax[1] - 1, imax[2] - 1));
+
+  const auto [max_err, sum2_err] = ErrorNorms::eval(
+      box, [=] CCTK_DEVICE(int i, int j, int k) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const vect<int, dim> I{i, j, k};
+        const Coord g = {ccoordx(I), ccoordy(I), ccoordz(I)};
+
+        const Jac_t jac = mp.jac_g2l_g(patch, g);
+        const dJac_t djac = mp.djac_g2l_g(patch, g);
+
+        return Errors{
+            jac[0][0] - cJ1x(I),    jac[0][1] - cJ1y(I),
+            jac[0][2] - cJ1z(I),    jac[1][0] - cJ2x(I),
+            jac[1][1] - cJ2y(I),    jac[1][2] - cJ2z(I),
+            jac[2][0] - cJ3x(I),    jac[2][1] - cJ3y(I),
+            jac[2][2] - cJ3z(I),    djac[0][0] - cdJ1xx(I),
+            djac[0][1] - cdJ1xy(I), djac[0][2] - cdJ1xz(I),
+            djac[0][3] - cdJ1yy(I), djac[0][4] - cdJ1yz(I),
+            djac[0][5] - cdJ1zz(I), djac[1][0] - cdJ2xx(I),
+            djac[1][1] - cdJ2xy(I), djac[1][2] - cdJ2xz(I),
+            djac[1][3] - cdJ2yy(I), djac[1][4] - cdJ2yz(I),
+            djac[1][5] - cdJ2zz(I), djac[2][0] - cdJ3xx(I),
+            djac[2][1] - cdJ3xy(I), djac[2][2] - cdJ3xz(I),
+            djac[2][3] - cdJ3yy(I), djac[2][4] - cdJ3yz(I),
+            djac[2][5] - cdJ3zz(I)};
+      });
+
+#pragma omp critical(TestCurvBase_ReduceJacobianErrors)
+  {
+    PatchNorms &norms = patch_norms.at(patch);
+    for (int c = 0; c < ncomps; ++c) {
+      norms.max_err[c] = max(norms.max_err[c], max_err[c]);
+      norms.sum2_err[c] += sum2_err[c];
+    }
+    norms.npoints += box.numPts();
+  }
+}
+
+extern "C" void TestCurvBase_OutputJacobianNorms(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_OutputJacobianNorms;
+  DECLARE_CCTK_PARAMETERS;
+
+  for (PatchNorms &norms : patch_norms) {
+    amrex::ParallelDescriptor::ReduceRealMax(norms.max_err.data(), ncomps);
+    amrex::ParallelDescriptor::ReduceRealSum(norms.sum2_err.data(), ncomps);
+    amrex::ParallelDescriptor::ReduceRealSum(norms.npoints);
+  }
+
+  // The norms are reduced onto every process, so all of them abort alike
+  if (jacobian_norms_tolerance >= 0)
+    for (size_t patch = 0; patch < patch_norms.size(); ++patch)
+      for (int c = 0; c < ncomps; ++c) {
+        const CCTK_REAL err = patch_norms[patch].max_err[c];
+        if (!(err <= jacobian_norms_tolerance))
+          CCTK_VERROR("Jacobian error of %s on patch %zu is %g, exceeding the "
+                      "tolerance %g",
+                      comp_names[c], patch, double(err),
+                      double(jacobian_norms_tolerance));
+      }
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename =
+      string(out_dir) + "/testcurvbase-jacobian_norms.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  fprintf(file, "# 1:patch\t2:component\t3:npoints\t4:max\t5:L2\n");
+  for (size_t patch = 0; patch < patch_norms.size(); ++patch) {
+    const PatchNorms &norms = patch_norms[patch];
+    for (int c = 0; c < ncomps; ++c) {
+      const CCTK_REAL l2 = norms.npoints > 0
+                               ? sqrt(norms.sum2_err[c] / norms.npoints)
+                               : CCTK_REAL{0};
+      fprintf(file, "%zu\t%s\t%.0f\t%.16e\t%.16e\n", patch, comp_names[c],
+              norms.npoints, norms.max_err[c], l2);
+    }
+  }
+
+  fclose(file);
+}
+
+} // namespace TestCurvBase
@@ -0,0 +1,120 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_Extraction.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+unique_ptr<SphereExtraction> extraction;
+
+extern "C" void TestCurvBase_ExtractionBegin(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_ExtractionBegin;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_EQUALS(patch_system, "none"))
+    CCTK_ERROR("No multi-patch system");
+
+  if (!extraction) {
+    vector<ExtractionSphere> spheres;
+    for (int s = 0; s < extraction_nspheres; ++s)
+      spheres.push_back(ExtractionSphere{extraction_radius[s],
+                                         {0, 0, 0},
+                                         extraction_ntheta,
+                                         extraction_nphi});
+    extraction =
+        make_unique<SphereExtraction>(move(spheres), extraction_order);
+  }
+
+  extraction->begin(dim);
+}
+
+extern "C" void TestCurvBase_ExtractionGather(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_ExtractionGather;
+
+  const vector<int> varindices{CCTK_VarIndex("CoordinatesX::ccoordx"),
+                               CCTK_VarIndex("CoordinatesX::ccoordy"),
+                               CCTK_VarIndex("CoordinatesX::ccoordz")};
+  extraction->gather(cctkGH, grid, varindices);
+}
+
+extern "C" void TestCurvBase_ExtractionOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_ExtractionOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  extraction->finish();
+
+  // Interpolated coordinates, then the same in the spherical basis, where the
+  // position vector is (r, 0, 0)
+  vector<CCTK_REAL> max_err_cart(extraction->num_spheres(), 0);
+  vector<CCTK_REAL> max_err_sph(extraction->num_spheres(), 0);
+  for (size_t s = 0; s < extraction->num_spheres(); ++s) {
+    const ExtractionSphere &sph = extraction->sphere(s);
+    for (int i = 0; i < sph.ntheta; ++i) {
+      for (int j = 0; j < sph.nphi; ++j) {
+        const CCTK_REAL th = extraction->theta(s, i);
+        const CCTK_REAL ph = extraction->phi(s, j);
+        const array<CCTK_REAL, dim> x{sph.radius * sin(th) * cos(ph),
+                                      sph.radius * sin(th) * sin(ph),
+                                      sph.radius * cos(th)};
+        for (int d = 0; d < dim; ++d)
+          max_err_cart[s] =
+              max(max_err_cart[s],
+                  fabs(extraction->values(s, d)[i * sph.nphi + j] - x[d]));
+      }
+    }
+  }
+
+  extraction->to_spherical_vector({0, 1, 2});
+  for (size_t s = 0; s < extraction->num_spheres(); ++s) {
+    const ExtractionSphere &sph = extraction->sphere(s);
+    const array<CCTK_REAL, dim> xsph{sph.radius, 0, 0};
+    for (int n = 0; n < sph.ntheta * sph.nphi; ++n)
+      for (int d = 0; d < dim; ++d)
+        max_err_sph[s] =
+            max(max_err_sph[s], fabs(extraction->values(s, d)[n] - xsph[d]));
+  }
+
+  // The results are combined on every process, so all of them abort alike
+  if (extraction_tolerance >= 0)
+    for (size_t s = 0; s < extraction->num_spheres(); ++s)
+      if (!(max(max_err_cart[s], max_err_sph[s]) <= extraction_tolerance))
+        CCTK_VERROR("Extraction error on sphere %zu is %g, exceeding the "
+                    "tolerance %g",
+                    s, double(max(max_err_cart[s], max_err_sph[s])),
+                    double(extraction_tolerance));
+
+  if (CCTK_MyProc(cctkGH) == 0) {
+    CCTK_CreateDirectory(0755, out_dir);
+    const string filename = string(out_dir) + "/testcurvbase-extraction.tsv";
+    FILE *const file = fopen(filename.c_str(), "w");
+    if (file == nullptr)
+      CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+    fprintf(file, "# 1:sphere\t2:radius\t3:npoints\t4:max_cart\t5:max_sph\n");
+    for (size_t s = 0; s < extraction->num_spheres(); ++s) {
+      const ExtractionSphere &sph = extraction->sphere(s);
+      fprintf(file, "%zu\t%.16e\t%d\t%.16e\t%.16e\n", s, sph.radius,
+              sph.ntheta * sph.nphi, max_err_cart[s], max_err_sph[s]);
+    }
+
+    fclose(file);
+  }
+
+  // Device memory has to be released before AMReX shuts down
+  extraction.reset();
+}
+
+} // namespace TestCurvBase
@@ -0,0 +1,141 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_MultiPatch.hxx>
+
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+// Geometry points of this process that differ from a recomputation, summed
+// over all regrids
+long long geometry_mismatches = 0;
+int geometry_checked_regrids = 0;
+
+extern "C" void TestCurvBase_GeometryCacheEstimateError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_GeometryCacheEstimateError;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!CCTK_EQUALS(patch_system, "Spherical"))
+    CCTK_ERROR("The geometry cache test needs the Spherical patch system");
+
+  // The shell moves outwards, so each regrid keeps some boxes and replaces
+  // others
+  const CCTK_REAL r0 =
+      geometry_cache_shell_radius + geometry_cache_shell_speed * cctk_time;
+  const CCTK_REAL width = geometry_cache_shell_width;
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        regrid_error(p.I) = std::fabs(p.x - r0) <= width ? 1 : 0;
+      });
+}
+
+extern "C" void TestCurvBase_GeometryCacheCheck(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_GeometryCacheCheck;
+
+  auto mp = active_mp();
+
+  const array<GF3D2<const CCTK_REAL>, 9> Jac{cJ1x, cJ1y, cJ1z, cJ2x, cJ2y,
+                                              cJ2z, cJ3x, cJ3y, cJ3z};
+  const array<GF3D2<const CCTK_REAL>, 18> dJac{
+      cdJ1xx, cdJ1xy, cdJ1xz, cdJ1yy, cdJ1yz, cdJ1zz, cdJ2xx, cdJ2xy, cdJ2xz,
+      cdJ2yy, cdJ2yz, cdJ2zz, cdJ3xx, cdJ3xy, cdJ3xz, cdJ3yy, cdJ3yz, cdJ3zz};
+
+  amrex::Gpu::DeviceVector<int> mismatches(1, 0);
+  int *const count = mismatches.data();
+
+  // The same evaluations as in CurvBase_MultiPatch_Coordinates_Setup; any
+  // difference, however small, is an error of the cache
+  grid.loop_all_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const Coord g = mp.l2g(p.patch, {p.x, p.y, p.z});
+        if (vcoordx(p.I) != g[0] || vcoordy(p.I) != g[1] ||
+            vcoordz(p.I) != g[2])
+          amrex::Gpu::Atomic::Add(count, 1);
+      });
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const Coord l = {p.x, p.y, p.z};
+        const Coord g = mp.l2g(p.patch, l);
+        const Jac_t jac = mp.jac_g2l_l(p.patch, l);
+        const dJac_t djac = mp.djac_g2l_l(p.patch, l);
+
+        bool differs = ccoordx(p.I) != g[0] || ccoordy(p.I) != g[1] ||
+                       ccoordz(p.I) != g[2];
+        for (int a = 0; a < 3; ++a) {
+          for (int b = 0; b < 3; ++b)
+            differs |= Jac[3 * a + b](p.I) != jac[a][b];
+          for (int b = 0; b < 6; ++b)
+            differs |= dJac[6 * a + b](p.I) != djac[a][b];
+        }
+        if (differs)
+          amrex::Gpu::Atomic::Add(count, 1);
+      });
+
+  int result = 0;
+  amrex::Gpu::copy(amrex::Gpu::deviceToHost, mismatches.begin(),
+                   mismatches.end(), &result);
+
+#pragma omp atomic
+  geometry_mismatches += result;
+}
+
+extern "C" void TestCurvBase_GeometryCacheCount(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_GeometryCacheCount;
+
+  ++geometry_checked_regrids;
+}
+
+extern "C" void TestCurvBase_GeometryCacheOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_GeometryCacheOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  long long mismatches = geometry_mismatches;
+  amrex::ParallelDescriptor::ReduceLongSum(mismatches);
+
+  if (!cache_geometry)
+    CCTK_WARN(CCTK_WARN_ALERT,
+              "The geometry cache is disabled; only the uncached geometry "
+              "was checked");
+  if (geometry_checked_regrids == 0)
+    CCTK_ERROR("No regrid happened; the geometry cache was not tested");
+  if (mismatches != 0)
+    CCTK_VERROR("%lld geometry points differ from a recomputation after %d "
+                "regrids",
+                mismatches, geometry_checked_regrids);
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename =
+      string(out_dir) + "/testcurvbase-geometry_cache.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  fprintf(file, "# 1:mismatches\n");
+  fprintf(file, "%lld\n", mismatches);
+
+  fclose(file);
+}
+
+} // namespace TestCurvBase
@@ -0,0 +1,192 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_MultiPatch.hxx>
+#include <CurvBase_Radiative.hxx>
+
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+// A scalar and the six components of a symmetric tensor
+constexpr int nradiative = 7;
+const array<const char *, nradiative> radiative_names{
+    "rad_u", "rad_gxx", "rad_gxy", "rad_gxz", "rad_gyy", "rad_gyz", "rad_gzz"};
+
+// Tensor components are g_ij = delta_ij + a_ij u
+constexpr array<CCTK_REAL, nradiative> radiative_values{0, 1, 0, 0, 1, 0, 1};
+constexpr array<CCTK_REAL, nradiative> radiative_amplitudes{
+    1, 1.0, 0.5, 0.25, 2.0, -0.5, 3.0};
+
+// Maximum errors and radial grid spacing of this process
+array<CCTK_REAL, nradiative> radiative_errors;
+CCTK_REAL radiative_dr;
+
+// Outgoing wave u = f(t - r) / r at t = 0 with f(v) = exp(-(v + r0)^2 /
+// (2 W^2)), and its exact time derivative
+CCTK_HOST CCTK_DEVICE inline void outgoing_wave(const CCTK_REAL r0,
+                                                const CCTK_REAL W,
+                                                const CCTK_REAL r, CCTK_REAL &u,
+                                                CCTK_REAL &dt_u) {
+  u = std::exp(-(r0 - r) * (r0 - r) / (2 * W * W)) / r;
+  dt_u = -(r0 - r) / (W * W) * u;
+}
+
+extern "C" void TestCurvBase_RadiativeBegin(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_RadiativeBegin;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!CCTK_EQUALS(patch_system, "Spherical") &&
+      !CCTK_EQUALS(patch_system, "CubedSphere"))
+    CCTK_ERROR("The radiative boundary test needs the Spherical or "
+               "CubedSphere patch system");
+
+  radiative_errors.fill(0);
+  radiative_dr = 0;
+}
+
+extern "C" void TestCurvBase_RadiativeInitial(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_RadiativeInitial;
+  DECLARE_CCTK_PARAMETERS;
+
+  const array<GF3D2<CCTK_REAL>, nradiative> vars{
+      rad_u, rad_gxx, rad_gxy, rad_gxz, rad_gyy, rad_gyz, rad_gzz};
+
+  const CCTK_REAL r0 = radiative_radius;
+  const CCTK_REAL W = radiative_width;
+  const array<CCTK_REAL, nradiative> values = radiative_values;
+  const array<CCTK_REAL, nradiative> amplitudes = radiative_amplitudes;
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const CCTK_REAL r =
+            std::sqrt(ccoordx(p.I) * ccoordx(p.I) + ccoordy(p.I) * ccoordy(p.I) +
+                      ccoordz(p.I) * ccoordz(p.I));
+        CCTK_REAL u, dt_u;
+        outgoing_wave(r0, W, r, u, dt_u);
+        for (int n = 0; n < nradiative; ++n)
+          vars[n](p.I) = values[n] + amplitudes[n] * u;
+      });
+}
+
+extern "C" void TestCurvBase_RadiativeCheck(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_RadiativeCheck;
+  DECLARE_CCTK_PARAMETERS;
+
+  const array<GF3D2<CCTK_REAL>, nradiative> rhss{
+      rad_u_rhs,   rad_gxx_rhs, rad_gxy_rhs, rad_gxz_rhs,
+      rad_gyy_rhs, rad_gyz_rhs, rad_gzz_rhs};
+
+  const CCTK_REAL r0 = radiative_radius;
+  const CCTK_REAL W = radiative_width;
+  const array<CCTK_REAL, nradiative> values = radiative_values;
+  const array<CCTK_REAL, nradiative> amplitudes = radiative_amplitudes;
+
+  // The scalar on its own, the tensor through the tensor interface
+  apply_radiative(cctkGH, grid, rad_u, rad_u_rhs, RadiativeCondition{0, 1, 1});
+  const array<GF3D2<const CCTK_REAL>, 6> gs{rad_gxx, rad_gxy, rad_gxz,
+                                            rad_gyy, rad_gyz, rad_gzz};
+  const array<GF3D2<CCTK_REAL>, 6> gs_rhs{rad_gxx_rhs, rad_gxy_rhs,
+                                          rad_gxz_rhs, rad_gyy_rhs,
+                                          rad_gyz_rhs, rad_gzz_rhs};
+  array<RadiativeCondition, 6> gs_conds;
+  for (int n = 0; n < 6; ++n)
+    gs_conds[n] = RadiativeCondition{values[1 + n], 1, 1};
+  apply_radiative(cctkGH, grid, gs, gs_rhs, gs_conds);
+
+  // Compare the RHS in the ghost zones beyond the outer radial face
+  const Patch &patch = *multipatch().get_patch(grid.patch);
+  const RadialMap radial = radial_map(patch);
+  const int d = radial.dir;
+  if (d < 0 || !patch.faces[1][d].is_outer_boundary ||
+      !cctk_bbox[2 * d + 1])
+    return;
+  const CCTK_REAL lmax = patch.xmax[d];
+
+  amrex::Gpu::DeviceVector<CCTK_REAL> errors(nradiative, 0);
+  CCTK_REAL *const errs = errors.data();
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const CCTK_REAL l = d == 0 ? p.x : d == 1 ? p.y : p.z;
+        if (l <= lmax)
+          return;
+        const CCTK_REAL r =
+            std::sqrt(ccoordx(p.I) * ccoordx(p.I) + ccoordy(p.I) * ccoordy(p.I) +
+                      ccoordz(p.I) * ccoordz(p.I));
+        CCTK_REAL u, dt_u;
+        outgoing_wave(r0, W, r, u, dt_u);
+        for (int n = 0; n < nradiative; ++n)
+          amrex::Gpu::Atomic::Max(
+              &errs[n], std::fabs(rhss[n](p.I) - amplitudes[n] * dt_u));
+      });
+
+  array<CCTK_REAL, nradiative> result;
+  amrex::Gpu::copy(amrex::Gpu::deviceToHost, errors.begin(), errors.end(),
+                   result.begin());
+  const CCTK_REAL dr = radial.scale * cctk_delta_space[d] / cctk_levfac[d];
+
+#pragma omp critical(TestCurvBase_Radiative)
+  {
+    for (int n = 0; n < nradiative; ++n)
+      radiative_errors[n] = max(radiative_errors[n], result[n]);
+    radiative_dr = max(radiative_dr, dr);
+  }
+}
+
+extern "C" void TestCurvBase_RadiativeOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_RadiativeOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  array<CCTK_REAL, nradiative + 1> maxima;
+  copy(radiative_errors.begin(), radiative_errors.end(), maxima.begin());
+  maxima[nradiative] = radiative_dr;
+  amrex::ParallelDescriptor::ReduceRealMax(maxima.data(), int(maxima.size()));
+  const CCTK_REAL dr = maxima[nradiative];
+
+  if (dr == 0)
+    CCTK_ERROR("No outer radial face found; the radiative boundary was not "
+               "tested");
+  // The one-sided radial derivative is second order
+  if (radiative_error_coefficient >= 0)
+    for (int n = 0; n < nradiative; ++n)
+      if (maxima[n] > radiative_error_coefficient * dr * dr)
+        CCTK_VERROR("The error %g of the radiative RHS of %s exceeds %g dr^2 "
+                    "with dr = %g",
+                    double(maxima[n]), radiative_names[n],
+                    double(radiative_error_coefficient), double(dr));
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename = string(out_dir) + "/testcurvbase-radiative.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  fprintf(file, "# 1:variable\t2:max_error\t3:max_error/dr^2\n");
+  for (int n = 0; n < nradiative; ++n)
+    fprintf(file, "%s\t%.16e\t%.16e\n", radiative_names[n], maxima[n],
+            maxima[n] / (dr * dr));
+
+  fclose(file);
+}
+
+} // namespace TestCurvBase
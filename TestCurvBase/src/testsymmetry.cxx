@@ -0,0 +1,173 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_MultiPatch.hxx>
+#include <CurvBase_Symmetry.hxx>
+
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+// A scalar and the three components of a vector
+constexpr int nsymmetry = 4;
+const array<const char *, nsymmetry> symmetry_names{"sym_u", "sym_vx",
+                                                    "sym_vy", "sym_vz"};
+
+// Maximum errors and number of checked ghost cells of this process
+array<CCTK_REAL, nsymmetry> symmetry_errors;
+long long symmetry_checked_cells;
+
+// The scalar u = exp(-(x^2 + 2 y^2 + 3 z^2) / 8) is even in x, y and z. Its
+// gradient v is a vector, whose component a is odd in the coordinate a only.
+CCTK_HOST CCTK_DEVICE inline array<CCTK_REAL, nsymmetry>
+symmetric_fields(const CCTK_REAL x, const CCTK_REAL y, const CCTK_REAL z) {
+  const CCTK_REAL u = std::exp(-(x * x + 2 * y * y + 3 * z * z) / 8);
+  return {u, -x / 4 * u, -y / 2 * u, -3 * z / 4 * u};
+}
+
+extern "C" void TestCurvBase_SymmetryBegin(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_SymmetryBegin;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_EQUALS(symmetry, "none"))
+    CCTK_ERROR("The symmetry test needs a symmetry");
+
+  symmetry_errors.fill(0);
+  symmetry_checked_cells = 0;
+}
+
+extern "C" void TestCurvBase_SymmetryInitial(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_SymmetryInitial;
+
+  const array<GF3D2<CCTK_REAL>, nsymmetry> vars{sym_u, sym_vx, sym_vy,
+                                                sym_vz};
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const array<CCTK_REAL, nsymmetry> vals =
+            symmetric_fields(ccoordx(p.I), ccoordy(p.I), ccoordz(p.I));
+        for (int n = 0; n < nsymmetry; ++n)
+          vars[n](p.I) = vals[n];
+      });
+}
+
+extern "C" void TestCurvBase_SymmetryCheck(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_SymmetryCheck;
+
+  const array<GF3D2<CCTK_REAL>, nsymmetry> vars{sym_u, sym_vx, sym_vy,
+                                                sym_vz};
+
+  apply_symmetries(cctkGH, grid, sym_u, scalar_parity);
+  for (int a = 0; a < dim; ++a)
+    apply_symmetries(cctkGH, grid, vars[1 + a], vector_parity(a));
+
+  // Compare the ghost cells that depend on the interior alone: those beyond
+  // symmetry faces of the patch, including their edges and corners, but not
+  // beyond any other face of the box
+  const Patch &patch = *multipatch().get_patch(grid.patch);
+  array<bool, 2 * dim> filled;
+  for (int d = 0; d < dim; ++d)
+    for (int f = 0; f < 2; ++f)
+      filled[2 * d + f] =
+          patch.faces[f][d].symmetry != 0 && cctk_bbox[2 * d + f];
+  const array<int, dim> ng{cctk_nghostzones[0], cctk_nghostzones[1],
+                           cctk_nghostzones[2]};
+  const array<int, dim> np{cctk_lsh[0] - 1, cctk_lsh[1] - 1,
+                           cctk_lsh[2] - 1};
+
+  amrex::Gpu::DeviceVector<CCTK_REAL> errors(nsymmetry, 0);
+  CCTK_REAL *const errs = errors.data();
+  amrex::Gpu::DeviceVector<int> checked(1, 0);
+  int *const count = checked.data();
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        bool ghost = false;
+        for (int d = 0; d < dim; ++d) {
+          const int f = p.I[d] < ng[d]            ? 0
+                        : p.I[d] >= np[d] - ng[d] ? 1
+                                                  : -1;
+          if (f < 0)
+            continue;
+          if (!filled[2 * d + f])
+            return;
+          ghost = true;
+        }
+        if (!ghost)
+          return;
+
+        const array<CCTK_REAL, nsymmetry> vals =
+            symmetric_fields(ccoordx(p.I), ccoordy(p.I), ccoordz(p.I));
+        for (int n = 0; n < nsymmetry; ++n)
+          amrex::Gpu::Atomic::Max(&errs[n],
+                                  std::fabs(vars[n](p.I) - vals[n]));
+        amrex::Gpu::Atomic::Add(count, 1);
+      });
+
+  array<CCTK_REAL, nsymmetry> result;
+  amrex::Gpu::copy(amrex::Gpu::deviceToHost, errors.begin(), errors.end(),
+                   result.begin());
+  int cells = 0;
+  amrex::Gpu::copy(amrex::Gpu::deviceToHost, checked.begin(), checked.end(),
+                   &cells);
+
+#pragma omp critical(TestCurvBase_Symmetry)
+  {
+    for (int n = 0; n < nsymmetry; ++n)
+      symmetry_errors[n] = max(symmetry_errors[n], result[n]);
+    symmetry_checked_cells += cells;
+  }
+}
+
+extern "C" void TestCurvBase_SymmetryOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_SymmetryOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  array<CCTK_REAL, nsymmetry> maxima = symmetry_errors;
+  amrex::ParallelDescriptor::ReduceRealMax(maxima.data(), int(maxima.size()));
+  long long cells = symmetry_checked_cells;
+  amrex::ParallelDescriptor::ReduceLongSum(cells);
+
+  if (cells == 0)
+    CCTK_ERROR("No symmetry face found; the symmetries were not tested");
+  if (symmetry_tolerance >= 0)
+    for (int n = 0; n < nsymmetry; ++n)
+      if (maxima[n] > symmetry_tolerance)
+        CCTK_VERROR("The error %g of the symmetry ghost zones of %s exceeds "
+                    "%g",
+                    double(maxima[n]), symmetry_names[n],
+                    double(symmetry_tolerance));
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename = string(out_dir) + "/testcurvbase-symmetry.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  fprintf(file, "# 1:variable\t2:checked_cells\t3:max_error\n");
+  for (int n = 0; n < nsymmetry; ++n)
+    fprintf(file, "%s\t%lld\t%.16e\n", symmetry_names[n], cells, maxima[n]);
+
+  fclose(file);
+}
+
+} // namespace TestCurvBase
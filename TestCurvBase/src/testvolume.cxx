@@ -0,0 +1,115 @@
+#include <loop_device.hxx>
+
+#include <CurvBase_Reduction.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TestCurvBase {
+using namespace Loop;
+using namespace CurvBase;
+using namespace std;
+
+const array<const char *, dim> coord_names{"ccoordx", "ccoordy", "ccoordz"};
+
+// Integrands evaluated inside the reduction kernel
+constexpr int nintegrands = 2;
+const array<const char *, nintegrands> integrand_names{"r2", "z2"};
+
+VolumeReduction volume_reduction;
+VolumeReduction integrand_reduction;
+
+extern "C" void TestCurvBase_VolumeBegin(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_VolumeBegin;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_EQUALS(patch_system, "none"))
+    CCTK_ERROR("No multi-patch system");
+
+  volume_reduction.begin(dim);
+  integrand_reduction.begin(nintegrands);
+}
+
+extern "C" void TestCurvBase_VolumeReduce(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestCurvBase_VolumeReduce;
+
+  const vector<int> varindices{CCTK_VarIndex("CoordinatesX::ccoordx"),
+                               CCTK_VarIndex("CoordinatesX::ccoordy"),
+                               CCTK_VarIndex("CoordinatesX::ccoordz")};
+  volume_reduction.reduce(cctkGH, grid, varindices);
+
+  integrand_reduction.reduce<nintegrands>(
+      cctkGH, grid, [=] CCTK_DEVICE(int i, int j, int k) {
+        const vect<int, dim> I{i, j, k};
+        const CCTK_REAL x = ccoordx(I), y = ccoordy(I), z = ccoordz(I);
+        return array<CCTK_REAL, nintegrands>{x * x + y * y + z * z, z * z};
+      });
+}
+
+extern "C" void TestCurvBase_VolumeOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestCurvBase_VolumeOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  volume_reduction.finish();
+  integrand_reduction.finish();
+
+  if (volume_tolerance >= 0) {
+    if (!CCTK_EQUALS(patch_system, "Spherical"))
+      CCTK_ERROR("The volume integrals are only known for the Spherical patch "
+                 "system");
+    // Shell rmin <= r <= rmax: V = 4/3 pi (rmax^3 - rmin^3) and the integral
+    // of r^2 is 4/5 pi (rmax^5 - rmin^5), a third of which is that of z^2
+    const CCTK_REAL r0 = spherical_rmin, r1 = spherical_rmax;
+    const CCTK_REAL volume = 4 * M_PI / 3 * (pow(r1, 3) - pow(r0, 3));
+    const CCTK_REAL r2 = 4 * M_PI / 5 * (pow(r1, 5) - pow(r0, 5));
+    const array<CCTK_REAL, nintegrands> exact{r2, r2 / 3};
+
+    const CCTK_REAL volume_error =
+        fabs(volume_reduction.norms(0).volume / volume - 1);
+    if (volume_error > volume_tolerance)
+      CCTK_VERROR("The relative error %g of the volume exceeds the tolerance "
+                  "%g",
+                  double(volume_error), double(volume_tolerance));
+    for (int n = 0; n < nintegrands; ++n) {
+      const CCTK_REAL error =
+          fabs(integrand_reduction.norms(n).integral / exact[n] - 1);
+      if (error > volume_tolerance)
+        CCTK_VERROR("The relative error %g of the integral of %s exceeds the "
+                    "tolerance %g",
+                    double(error), integrand_names[n], double(volume_tolerance));
+    }
+  }
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename = string(out_dir) + "/testcurvbase-volume.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  fprintf(file, "# 1:variable\t2:volume\t3:integral\t4:L1\t5:L2\t6:max\n");
+  for (int d = 0; d < dim; ++d) {
+    const VolumeNorms &norms = volume_reduction.norms(d);
+    fprintf(file, "%s\t%.16e\t%.16e\t%.16e\t%.16e\t%.16e\n", coord_names[d],
+            norms.volume, norms.integral, norms.l1, norms.l2, norms.max);
+  }
+  for (int n = 0; n < nintegrands; ++n) {
+    const VolumeNorms &norms = integrand_reduction.norms(n);
+    fprintf(file, "%s\t%.16e\t%.16e\t%.16e\t%.16e\t%.16e\n",
+            integrand_names[n], norms.volume, norms.integral, norms.l1,
+            norms.l2, norms.max);
+  }
+
+  fclose(file);
+}
+
+} // namespace TestCurvBase
@@ -1,17 +1,30 @@
+#include <CurvBase_Radiative.hxx>
+#include <CurvBase_Reduction.hxx>
+#include <CurvBase_Symmetry.hxx>
+#include <curvjacobians.hxx>
+#include <curvscratch.hxx>
+#include <curvtasks.hxx>
 #include <curvtrans.hxx>
 #include <curvtransderivs.hxx>
 #include <cx_derivsGF3D5.hxx>
 #include <cx_powerinline.hxx>
 #include <cx_utils.hxx>
 #include <loop_device.hxx>
+#include <schedule.hxx>
+
+#include <AMReX_ParallelDescriptor.H>
 
 #include <cctk.h>
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 namespace TestScalarWave {
 using namespace Loop;
@@ -56,9 +69,16 @@ extern "C" void TestScalarWave_Initial(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTSX_TestScalarWave_Initial;
   DECLARE_CCTK_PARAMETERS;
 
+  // The ghost zones of a radiative outer boundary are evolved as well
+  const auto loop = [&](const auto &kernel) {
+    if (radiative_boundary)
+      grid.loop_all_device<1, 1, 1>(grid.nghostzones, kernel);
+    else
+      grid.loop_int_device<1, 1, 1>(grid.nghostzones, kernel);
+  };
+
   if (CCTK_EQUALS(initial_condition, "Sine Wave")) {
-    grid.loop_int_device<1, 1, 1>(
-        grid.nghostzones,
+    loop(
         [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
           const CCTK_REAL kx = 0.1;
           const CCTK_REAL ky = 0.1;
@@ -68,8 +88,7 @@ extern "C" void TestScalarWave_Initial(CCTK_ARGUMENTS) {
                    ccoordz(p.I), kx, ky, kz, u(p.I), rho(p.I));
         });
   } else if (CCTK_EQUALS(initial_condition, "Gaussian")) {
-    grid.loop_int_device<1, 1, 1>(
-        grid.nghostzones,
+    loop(
         [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
           const CCTK_REAL x = ccoordx(p.I) - gaussian_shift_x;
           const CCTK_REAL y = ccoordy(p.I) - gaussian_shift_y;
@@ -82,71 +101,102 @@ extern "C" void TestScalarWave_Initial(CCTK_ARGUMENTS) {
   }
 }
 
-extern "C" void TestScalarWave_RHS(CCTK_ARGUMENTS) {
-  DECLARE_CCTK_ARGUMENTS_TestScalarWave_RHS;
-  DECLARE_CCTK_PARAMETERS;
+// A box of the RHS evaluation: its state, RHS, Jacobians and the temporaries
+// that carry the derivatives from the first to the second stage
+struct RHSBox {
+  static constexpr int ntmps = 9;
 
-  for (int d = 0; d < 3; ++d)
-    if (cctk_nghostzones[d] < deriv_order / 2)
-      CCTK_VERROR("Need at least %d ghost zones", deriv_order / 2);
+  CurvDerivs::BoxDesc box;
+  const CCTK_REAL *u, *rho;
+  CCTK_REAL *u_rhs, *rho_rhs;
+  CurvDerivs::JacobianPtrs jac;
+  // temporary GF3D5 gfs, kept across calls
+  CurvDerivs::Scratch<CCTK_REAL> fct;
+  array<GF3D5<CCTK_REAL>, 3> tl_du;
+  array<GF3D5<CCTK_REAL>, 6> tl_ddu;
 
-  const array<CCTK_REAL, 3> invDxyz{1. / CCTK_DELTA_SPACE(0),
-                                    1. / CCTK_DELTA_SPACE(1),
-                                    1. / CCTK_DELTA_SPACE(2)};
-
-  const GF3D2layout layout2(cctkGH, {1, 1, 1});
-  const GF3D5layout layout5 = CXUtils::get_GF3D5layout<1, 1, 1>(cctkGH);
+  RHSBox(const cGH *restrict const cctkGH, const CCTK_REAL *const u,
+         const CCTK_REAL *const rho, CCTK_REAL *const u_rhs,
+         CCTK_REAL *const rho_rhs)
+      : box(cctkGH), u(u), rho(rho), u_rhs(u_rhs), rho_rhs(rho_rhs),
+        jac(CurvDerivs::jacobian_ptrs(cctkGH)),
+        fct(box.grid, box.level, box.layout5, ntmps),
+        tl_du(fct.make_vec_gf()), tl_ddu(fct.make_smat_gf()) {
+    if (fct.count() != ntmps)
+      CCTK_VERROR("Wrong number of temporary variables: ntmps=%d itmp=%d",
+                  ntmps, fct.count());
+  }
+};
 
-  const array<const CCTK_REAL *, 9> gf_Jac{cJ1x, cJ1y, cJ1z, cJ2x, cJ2y,
-                                           cJ2z, cJ3x, cJ3y, cJ3z};
-  const array<const CCTK_REAL *, 18> gf_dJac{
-      cdJ1xx, cdJ1xy, cdJ1xz, cdJ1yy, cdJ1yz, cdJ1zz, cdJ2xx, cdJ2xy, cdJ2xz,
-      cdJ2yy, cdJ2yz, cdJ2zz, cdJ3xx, cdJ3xy, cdJ3xz, cdJ3yy, cdJ3yz, cdJ3zz};
+// First stage: first and second derivatives of u
+void calc_derivs(const RHSBox &b) {
+  DECLARE_CCTK_PARAMETERS;
 
-  // allocate temporary GF3D5 gfs
-  const int ntmps = 9;
-  int itmp = 0;
-  CXUtils::GF3D5Factory<CCTK_REAL> fct(layout5, ntmps, itmp);
-  const auto tl_du = fct.make_vec_gf();
-  const auto tl_ddu = fct.make_smat_gf();
-  if (itmp != ntmps)
-    CCTK_VERROR("Wrong number of temporary variables: ntmps=%d itmp=%d", ntmps,
-                itmp);
-  itmp = -1;
+  const Loop::GridDescBaseDevice &grid = b.box.grid;
+  const GF3D2layout &layout2 = b.box.layout2;
+  const GF3D5layout &layout5 = b.box.layout5;
+  const array<CCTK_REAL, 3> &invDxyz = b.box.invDxyz;
 
-  const Loop::GridDescBaseDevice grid(cctkGH);
+  for (int d = 0; d < 3; ++d)
+    if (grid.nghostzones[d] < deriv_order / 2)
+      CCTK_VERROR("Need at least %d ghost zones", deriv_order / 2);
 
   if (use_jacobian) {
 
     // Derivatives of Cartesian Coordinate
     switch (deriv_order) {
     case 2: {
-      CurvDerivs::calc_transderivs<1, 1, 1, 2>(
-          grid, layout5, tl_du, tl_ddu, layout2, u, invDxyz, gf_Jac, gf_dJac);
+      CurvDerivs::calc_transderivs<1, 1, 1, 2>(grid, layout5, b.tl_du,
+                                               b.tl_ddu, layout2, b.u, invDxyz,
+                                               b.jac.Jac, b.jac.dJac);
       break;
     }
     case 4: {
-      CurvDerivs::calc_transderivs<1, 1, 1, 4>(
-          grid, layout5, tl_du, tl_ddu, layout2, u, invDxyz, gf_Jac, gf_dJac);
+      CurvDerivs::calc_transderivs<1, 1, 1, 4>(grid, layout5, b.tl_du,
+                                               b.tl_ddu, layout2, b.u, invDxyz,
+                                               b.jac.Jac, b.jac.dJac);
       break;
     }
     case 6: {
-      CurvDerivs::calc_transderivs<1, 1, 1, 6>(
-          grid, layout5, tl_du, tl_ddu, layout2, u, invDxyz, gf_Jac, gf_dJac);
+      CurvDerivs::calc_transderivs<1, 1, 1, 6>(grid, layout5, b.tl_du,
+                                               b.tl_ddu, layout2, b.u, invDxyz,
+                                               b.jac.Jac, b.jac.dJac);
       break;
     }
     case 8: {
-      CurvDerivs::calc_transderivs<1, 1, 1, 8>(
-          grid, layout5, tl_du, tl_ddu, layout2, u, invDxyz, gf_Jac, gf_dJac);
+      CurvDerivs::calc_transderivs<1, 1, 1, 8>(grid, layout5, b.tl_du,
+                                               b.tl_ddu, layout2, b.u, invDxyz,
+                                               b.jac.Jac, b.jac.dJac);
       break;
     }
     default:
       assert(0 && "Invalid derivative order");
     }
 
-    const auto ddu11 = tl_ddu[0].ptr;
-    const auto ddu22 = tl_ddu[3].ptr;
-    const auto ddu33 = tl_ddu[5].ptr;
+  } else {
+
+    // Derivatives of Curvilinear Coordinate
+    CXUtils::calc_derivs2nd<1, 1, 1>(grid, layout5, b.tl_du, b.tl_ddu, layout2,
+                                     b.u, invDxyz, deriv_order);
+  }
+}
+
+// Second stage: the RHS from the derivatives of the first stage
+void calc_rhs(const RHSBox &b) {
+  DECLARE_CCTK_PARAMETERS;
+
+  const Loop::GridDescBaseDevice &grid = b.box.grid;
+  const GF3D2layout &layout2 = b.box.layout2;
+  const GF3D5layout &layout5 = b.box.layout5;
+  const CCTK_REAL *restrict const rho = b.rho;
+  CCTK_REAL *restrict const u_rhs = b.u_rhs;
+  CCTK_REAL *restrict const rho_rhs = b.rho_rhs;
+
+  if (use_jacobian) {
+
+    const auto ddu11 = b.tl_ddu[0].ptr;
+    const auto ddu22 = b.tl_ddu[3].ptr;
+    const auto ddu33 = b.tl_ddu[5].ptr;
 
     grid.loop_int_device<1, 1, 1>(
         grid.nghostzones,
@@ -159,16 +209,12 @@ extern "C" void TestScalarWave_RHS(CCTK_ARGUMENTS) {
 
   } else {
 
-    // Derivatives of Curvilinear Coordinate
-    CXUtils::calc_derivs2nd<1, 1, 1>(grid, layout5, tl_du, tl_ddu, layout2, u,
-                                     invDxyz, deriv_order);
-
-    const auto du1 = tl_du[0].ptr;
-    const auto du2 = tl_du[1].ptr;
-    const auto du3 = tl_du[2].ptr;
-    const auto ddu11 = tl_ddu[0].ptr;
-    const auto ddu22 = tl_ddu[3].ptr;
-    const auto ddu33 = tl_ddu[5].ptr;
+    const auto du1 = b.tl_du[0].ptr;
+    const auto du2 = b.tl_du[1].ptr;
+    const auto du3 = b.tl_du[2].ptr;
+    const auto ddu11 = b.tl_ddu[0].ptr;
+    const auto ddu22 = b.tl_ddu[3].ptr;
+    const auto ddu33 = b.tl_ddu[5].ptr;
 
     if (CCTK_EQUALS(patch_system, "Spherical")) {
       grid.loop_int_device<1, 1, 1>(
@@ -211,8 +257,185 @@ extern "C" void TestScalarWave_RHS(CCTK_ARGUMENTS) {
   }
 }
 
+extern "C" void TestScalarWave_RHS(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestScalarWave_RHS;
+
+  const RHSBox b(cctkGH, u, rho, u_rhs, rho_rhs);
+  calc_derivs(b);
+  calc_rhs(b);
+}
+
+extern "C" void TestScalarWave_RHSTasks(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestScalarWave_RHSTasks;
+
+  const auto varindex = [](const char *name) {
+    const int vi = CCTK_VarIndex(name);
+    if (vi < 0)
+      CCTK_VERROR("Unknown variable \"%s\"", name);
+    return vi;
+  };
+  static const array<int, 2> state_vi{varindex("TestScalarWave::u"),
+                                      varindex("TestScalarWave::rho")};
+  static const array<int, 2> rhs_vi{varindex("TestScalarWave::u_rhs"),
+                                    varindex("TestScalarWave::rho_rhs")};
+
+  // Kept across calls, so that collecting the boxes and jobs does not
+  // allocate once the grid is stable
+  static vector<RHSBox> boxes;
+  static CurvDerivs::TaskGroup tasks;
+
+  // Collect the boxes of all patches and levels first, then evaluate them
+  // concurrently
+  boxes.clear();
+  CarpetX::active_levels->loop_serially(
+      [&](const int patch, const int level, const int index,
+          const int component, const cGH *restrict const local_cctkGH) {
+        const auto data = [&](const int vi) {
+          return static_cast<CCTK_REAL *>(
+              CCTK_VarDataPtrI(local_cctkGH, 0, vi));
+        };
+        boxes.emplace_back(local_cctkGH, data(state_vi[0]),
+                           data(state_vi[1]), data(rhs_vi[0]),
+                           data(rhs_vi[1]));
+      });
+
+  // The RHS of a box waits for its derivatives; the boxes are independent
+  tasks.reserve(2 * boxes.size());
+  for (const RHSBox &b : boxes) {
+    const int derivs = tasks.add<RHSBox, calc_derivs>(b);
+    tasks.add<RHSBox, calc_rhs>(b, derivs);
+  }
+  tasks.run();
+}
+
+extern "C" void TestScalarWave_RadiativeBoundary(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestScalarWave_RadiativeBoundary;
+  DECLARE_CCTK_PARAMETERS;
+
+  // u and its time derivative rho are both outgoing waves with the same
+  // falloff
+  const CurvBase::RadiativeCondition cond{0, 1, radiative_falloff};
+  CurvBase::apply_radiative(cctkGH, grid, u, u_rhs, cond);
+  CurvBase::apply_radiative(cctkGH, grid, rho, rho_rhs, cond);
+}
+
+extern "C" void TestScalarWave_Error(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestScalarWave_Error;
+  DECLARE_CCTK_PARAMETERS;
+
+  const bool is_gaussian = CCTK_EQUALS(initial_condition, "Gaussian");
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        CCTK_REAL u0, rho0;
+        if (is_gaussian) {
+          const CCTK_REAL x = ccoordx(p.I) - gaussian_shift_x;
+          const CCTK_REAL y = ccoordy(p.I) - gaussian_shift_y;
+          const CCTK_REAL z = ccoordz(p.I) - gaussian_shift_z;
+          gaussian(amplitude, gaussian_width, cctk_time, x, y, z, u0, rho0);
+        } else {
+          const CCTK_REAL kx = 0.1;
+          const CCTK_REAL ky = 0.1;
+          const CCTK_REAL kz = 0.1;
+          const CCTK_REAL freq = 1.0;
+          sinewave(amplitude, freq, cctk_time, ccoordx(p.I), ccoordy(p.I),
+                   ccoordz(p.I), kx, ky, kz, u0, rho0);
+        }
+        u_err(p.I) = u(p.I) - u0;
+        rho_err(p.I) = rho(p.I) - rho0;
+      });
+}
+
+// Norms of the error of u and rho: the current ones, and their maxima over
+// time. The coarse grid spacing in the first local direction is that of this
+// process.
+CurvBase::VolumeReduction error_reduction;
+array<CCTK_REAL, 2> max_error_l2{0, 0}, max_error_max{0, 0};
+CCTK_REAL error_dx = 0;
+
+extern "C" void TestScalarWave_ErrorNormsBegin(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestScalarWave_ErrorNormsBegin;
+
+  error_reduction.begin(2);
+}
+
+extern "C" void TestScalarWave_ErrorNormsReduce(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestScalarWave_ErrorNormsReduce;
+
+  static const vector<int> varindices{
+      CCTK_VarIndex("TestScalarWave::u_err"),
+      CCTK_VarIndex("TestScalarWave::rho_err")};
+  error_reduction.reduce(cctkGH, grid, varindices);
+
+  const CCTK_REAL dx = cctk_delta_space[0] / cctk_levfac[0];
+#pragma omp critical(TestScalarWave_ErrorNorms)
+  error_dx = max(error_dx, dx);
+}
+
+extern "C" void TestScalarWave_ErrorNormsFinish(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestScalarWave_ErrorNormsFinish;
+  DECLARE_CCTK_PARAMETERS;
+
+  error_reduction.finish();
+  for (int n = 0; n < 2; ++n) {
+    max_error_l2[n] = max(max_error_l2[n], error_reduction.norms(n).l2);
+    max_error_max[n] = max(max_error_max[n], error_reduction.norms(n).max);
+  }
+
+  if (error_coefficient >= 0) {
+    CCTK_REAL dx = error_dx;
+    amrex::ParallelDescriptor::ReduceRealMax(dx);
+    const CCTK_REAL l2 = error_reduction.norms(0).l2;
+    if (l2 > error_coefficient * dx * dx)
+      CCTK_VERROR("At t = %g, the L2 norm %g of the error of u exceeds %g "
+                  "dx^2 with dx = %g",
+                  double(cctk_time), double(l2), double(error_coefficient),
+                  double(dx));
+  }
+}
+
+extern "C" void TestScalarWave_ErrorNormsOutput(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestScalarWave_ErrorNormsOutput;
+  DECLARE_CCTK_PARAMETERS;
+
+  CCTK_REAL dx = error_dx;
+  amrex::ParallelDescriptor::ReduceRealMax(dx);
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  CCTK_CreateDirectory(0755, out_dir);
+  const string filename = string(out_dir) + "/testscalarwave-error_norms.tsv";
+  FILE *const file = fopen(filename.c_str(), "w");
+  if (file == nullptr)
+    CCTK_VERROR("Could not open file \"%s\" for writing", filename.c_str());
+
+  const array<const char *, 2> names{"u_err", "rho_err"};
+  fprintf(file, "# 1:variable\t2:max_L2\t3:max_L2/dx^2\t4:max_max\n");
+  for (int n = 0; n < 2; ++n)
+    fprintf(file, "%s\t%.16e\t%.16e\t%.16e\n", names[n], max_error_l2[n],
+            max_error_l2[n] / (dx * dx), max_error_max[n]);
+
+  fclose(file);
+}
+
 extern "C" void TestScalarWave_Sync(CCTK_ARGUMENTS) {
   // do nothing
 }
 
+extern "C" void TestScalarWave_ApplySymmetriesBeforeSync(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestScalarWave_ApplySymmetriesBeforeSync;
+
+  CurvBase::apply_symmetries(cctkGH, grid, u, CurvBase::scalar_parity, true);
+  CurvBase::apply_symmetries(cctkGH, grid, rho, CurvBase::scalar_parity, true);
+}
+
+extern "C" void TestScalarWave_ApplySymmetries(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestScalarWave_ApplySymmetries;
+
+  CurvBase::apply_symmetries(cctkGH, grid, u, CurvBase::scalar_parity);
+  CurvBase::apply_symmetries(cctkGH, grid, rho, CurvBase::scalar_parity);
+}
+
 } // namespace TestScalarWave